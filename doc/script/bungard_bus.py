@@ -0,0 +1,256 @@
+#!/usr/bin/env python
+"""\
+
+Decode a captured Bungard CCD/2 parallel bus and replay it on a virtual machine
+
+Lets firmware changes be checked without the mill. The input is either a list
+of strobed bytes or a raw logic analyzer capture of the eight data lines and
+the strobe. Every strobed byte is decoded as documented in bungard.c:
+
+  D7=0        Stepper byte. D0/D2/D4 step X/Y/Z, D1/D3/D5 set their
+              direction, D6 overrides the limit switches.
+  D7=1, D6=0  Latch1. D0-D3 spindle speed nibble, D4 spindle enable.
+  D7=1, D6=1  Latch2. D1 spindle brake, D2-D3 microstepping,
+              D4 stepper enable.
+
+The model tracks axis positions, step rates, spindle, brake and stepper enable
+state, and the steps taken with the limit override set. It writes a trajectory
+trace as CSV and flags violations:
+
+  - Strobe width or data setup before the strobe under 0.5us, and data changing
+    while the strobe is high. Raw captures only.
+  - Step bytes closer together than the maximum step rate allows.
+  - Steps while the steppers are disabled.
+
+The exit status is 1 if any violation was found, so it can gate a CI job.
+
+Input formats:
+
+  Strobe list (default): one strobed byte per line as 'time,value', with the
+  time in seconds and the value in decimal or 0x hex. '#' starts a comment.
+
+  Raw capture (--raw): CSV as exported by sigrok/PulseView, one sample per line
+  as 'time,D0,D1,...,D7,STROBE' with 0/1 levels. A header line is skipped. Use
+  --columns to give another column order.
+
+Examples:
+
+  bungard_bus.py capture.csv --raw --trace trace.csv
+  bungard_bus.py strobes.txt --steps-per-mm 250 --invert-dir 0x0a
+
+---------------------
+Part of Grbl
+
+Grbl is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+Grbl is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+---------------------
+"""
+
+from __future__ import print_function
+import argparse
+import sys
+
+AXES = 'XYZ'
+STEP_BITS = (0, 2, 4)           # X_STEP_BIT, Y_STEP_BIT, Z_STEP_BIT in cpu_map.h
+DIRECTION_BITS = (1, 3, 5)      # X_DIRECTION_BIT, Y_DIRECTION_BIT, Z_DIRECTION_BIT
+LIMIT_OVERRIDE_BIT = 6
+LATCH_BIT = 7
+LATCH2_BIT = 6
+
+MIN_SETUP = 0.5e-6              # LPT data setup before the strobe (s)
+MIN_STROBE = 0.5e-6             # LPT strobe width (s)
+
+
+class BusDecoder(object):
+    """Turns raw samples of the data lines and strobe into strobed bytes.
+    Feed samples in time order. Timing violations are collected in 'violations'."""
+
+    def __init__(self):
+        self.data = None
+        self.strobe = 0
+        self.data_change_time = None
+        self.strobe_rise_time = None
+        self.violations = []
+
+    def sample(self, time, data, strobe):
+        """Returns (time, byte) on a rising strobe edge, otherwise None."""
+        event = None
+        if data != self.data:
+            if self.strobe and self.data is not None:
+                self.violations.append((time, 'data changed while strobe high'))
+            self.data = data
+            self.data_change_time = time
+        if strobe and not self.strobe:
+            self.strobe_rise_time = time
+            if self.data_change_time is not None and time-self.data_change_time < MIN_SETUP:
+                self.violations.append((time, 'data setup %.3fus' % ((time-self.data_change_time)*1e6)))
+            event = (time, data)
+        elif self.strobe and not strobe:
+            if time-self.strobe_rise_time < MIN_STROBE:
+                self.violations.append((time, 'strobe width %.3fus' % ((time-self.strobe_rise_time)*1e6)))
+        self.strobe = strobe
+        return event
+
+
+class CCD2Model(object):
+    """Virtual CCD/2. Feed it strobed bytes in time order with write()."""
+
+    def __init__(self, steps_per_mm=(250.0, 250.0, 250.0), invert_step=0, invert_dir=0, max_step_rate=30000.0):
+        self.steps_per_mm = steps_per_mm
+        self.invert_step = invert_step
+        self.invert_dir = invert_dir
+        self.min_step_interval = 1.0/max_step_rate
+        self.position = [0, 0, 0]           # steps
+        self.velocity = [0.0, 0.0, 0.0]     # mm/min, from the last two steps of each axis
+        self.last_step_time = [None, None, None]
+        self.last_step_byte_time = None
+        self.limit_override = False
+        self.override_steps = 0
+        self.spindle_enable = False
+        self.spindle_speed = 0
+        self.spindle_brake = False
+        self.microstep = 0
+        self.steppers_enable = False
+        self.strobes = 0
+        self.violations = []
+
+    def write(self, time, byte):
+        """Applies one strobed byte. Returns True if it moved an axis."""
+        self.strobes += 1
+        if byte & (1 << LATCH_BIT):
+            if byte & (1 << LATCH2_BIT):
+                self.spindle_brake = bool(byte & 0x02)
+                self.microstep = (byte >> 2) & 0x03
+                self.steppers_enable = bool(byte & 0x10)
+            else:
+                self.spindle_speed = byte & 0x0F
+                self.spindle_enable = bool(byte & 0x10)
+            return False
+
+        # Stepper byte. The firmware writes one on every ISR tick, even without steps.
+        if self.last_step_byte_time is not None and time-self.last_step_byte_time < self.min_step_interval:
+            self.violations.append((time, 'step bytes %.2fus apart' % ((time-self.last_step_byte_time)*1e6)))
+        self.last_step_byte_time = time
+        self.limit_override = bool(byte & (1 << LIMIT_OVERRIDE_BIT))
+        steps = byte ^ self.invert_step
+        moved = False
+        for idx in range(3):
+            if not steps & (1 << STEP_BITS[idx]):
+                continue
+            moved = True
+            if (byte ^ self.invert_dir) & (1 << DIRECTION_BITS[idx]):
+                self.position[idx] -= 1
+                direction = -1.0
+            else:
+                self.position[idx] += 1
+                direction = 1.0
+            if self.last_step_time[idx] is not None and time > self.last_step_time[idx]:
+                self.velocity[idx] = direction*60.0/((time-self.last_step_time[idx])*self.steps_per_mm[idx])
+            self.last_step_time[idx] = time
+        if moved:
+            if not self.steppers_enable:
+                self.violations.append((time, 'step while steppers disabled'))
+            if self.limit_override:
+                self.override_steps += 1
+        return moved
+
+    def settle(self, time, timeout=0.1):
+        """Zeroes the velocity of axes that haven't stepped for the timeout."""
+        for idx in range(3):
+            if self.last_step_time[idx] is None or time-self.last_step_time[idx] > timeout:
+                self.velocity[idx] = 0.0
+
+    def mpos(self):
+        return [self.position[idx]/self.steps_per_mm[idx] for idx in range(3)]
+
+
+def read_strobes(lines):
+    for line in lines:
+        line = line.split('#')[0].strip()
+        if line:
+            time, value = line.split(',')[:2]
+            yield float(time), int(value, 0)
+
+
+def read_raw(lines, columns, decoder):
+    for line in lines:
+        fields = line.strip().split(',')
+        try:
+            time = float(fields[columns[0]])
+            data = 0
+            for bit in range(8):
+                if int(fields[columns[1+bit]]):
+                    data |= (1 << bit)
+            strobe = int(fields[columns[9]])
+        except (ValueError, IndexError):
+            continue # Header or partial line.
+        event = decoder.sample(time, data, strobe)
+        if event:
+            yield event
+
+
+TRACE_HEADER = 'time,x,y,z,vx,vy,vz,spindle,speed,brake,steppers,limit_override'
+
+def trace_line(time, model):
+    x, y, z = model.mpos()
+    vx, vy, vz = model.velocity
+    return '%.7f,%.4f,%.4f,%.4f,%.1f,%.1f,%.1f,%d,%d,%d,%d,%d' % (time, x, y, z, vx, vy, vz,
+        model.spindle_enable, model.spindle_speed, model.spindle_brake, model.steppers_enable,
+        model.limit_override)
+
+
+def main():
+    parser = argparse.ArgumentParser(description='Decode a Bungard CCD/2 bus capture and replay it on a virtual machine.')
+    parser.add_argument('capture', type=argparse.FileType('r'), help='strobe list or raw capture file, - for stdin')
+    parser.add_argument('--raw', action='store_true', help='input is a raw logic analyzer capture')
+    parser.add_argument('--columns', default='0,1,2,3,4,5,6,7,8,9',
+        help='raw capture column indices of time,D0..D7,STROBE (default: %(default)s)')
+    parser.add_argument('--steps-per-mm', default='250,250,250', help='X,Y,Z steps/mm as $100-$102 (default: %(default)s)')
+    parser.add_argument('--invert-step', type=lambda x: int(x, 0), default=0, help='step invert mask as $2, in bus bits')
+    parser.add_argument('--invert-dir', type=lambda x: int(x, 0), default=0, help='direction invert mask as $3, in bus bits')
+    parser.add_argument('--max-step-rate', type=float, default=30000.0, help='maximum stepper byte rate in Hz (default: %(default)s)')
+    parser.add_argument('--trace', type=argparse.FileType('w'), help='write a CSV trajectory trace, one line per step or latch write')
+    args = parser.parse_args()
+
+    steps_per_mm = [float(x) for x in args.steps_per_mm.split(',')]
+    model = CCD2Model(steps_per_mm, args.invert_step, args.invert_dir, args.max_step_rate)
+    decoder = BusDecoder()
+    if args.raw:
+        events = read_raw(args.capture, [int(x) for x in args.columns.split(',')], decoder)
+    else:
+        events = read_strobes(args.capture)
+
+    if args.trace:
+        print(TRACE_HEADER, file=args.trace)
+    time = 0.0
+    for time, byte in events:
+        model.settle(time)
+        if model.write(time, byte) or (byte & (1 << LATCH_BIT)):
+            if args.trace:
+                print(trace_line(time, model), file=args.trace)
+
+    violations = sorted(decoder.violations + model.violations)
+    x, y, z = model.mpos()
+    print('Strobes: %d  Time: %.6fs' % (model.strobes, time))
+    print('Position: X%.4f Y%.4f Z%.4f mm (%d,%d,%d steps)' % (x, y, z, model.position[0], model.position[1], model.position[2]))
+    print('Spindle: %s speed %d  Brake: %s  Steppers: %s  Microstep: %d' % (
+        'on' if model.spindle_enable else 'off', model.spindle_speed, 'on' if model.spindle_brake else 'off',
+        'enabled' if model.steppers_enable else 'disabled', model.microstep))
+    print('Steps with limit override: %d' % model.override_steps)
+    print('Violations: %d' % len(violations))
+    for time, message in violations[:50]:
+        print('  %.7fs: %s' % (time, message))
+    if len(violations) > 50:
+        print('  ...')
+    sys.exit(1 if violations else 0)
+
+
+if __name__ == '__main__':
+    main()
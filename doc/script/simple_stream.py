@@ -11,6 +11,10 @@ G02/03 arcs are special exceptions, where they inject short line
 segments directly into the planner. So there may not be a response 
 from grbl for the duration of the arc.
 
+Set SWITCH_BAUD_RATE to have grbl switch to a faster baud rate with
+the '$B=' command before streaming. Grbl waits for a '$B' line at
+the new rate to confirm the link, and otherwise stays at 115200.
+
 ---------------------
 The MIT License (MIT)
 
@@ -39,6 +43,8 @@ THE SOFTWARE.
 import serial
 import time
 
+SWITCH_BAUD_RATE = 0 # e.g. 250000, 500000 or 1000000. Zero to disable.
+
 # Open grbl serial port
 s = serial.Serial('/dev/tty.usbmodem1811',115200)
 
@@ -50,6 +56,24 @@ s.write("\r\n\r\n")
 time.sleep(2)   # Wait for grbl to initialize 
 s.flushInput()  # Flush startup text in serial input
 
+# Switch baud rate, if enabled. Refused or unconfirmed rates leave grbl at 115200.
+if SWITCH_BAUD_RATE :
+    s.write("$B=" + str(SWITCH_BAUD_RATE) + "\n")
+    s.flush()
+    time.sleep(0.05) # Give grbl time to switch first
+    if s.inWaiting() :
+        print 'Baud rate refused: ' + s.readline().strip()
+    else :
+        s.baudrate = SWITCH_BAUD_RATE
+        s.flushInput()
+        s.timeout = 0.5
+        s.write("$B\n")
+        if s.readline().strip() != 'ok' :
+            s.baudrate = 115200
+            s.timeout = 2.0
+            print 'Baud rate not confirmed: ' + s.readline().strip()
+        s.timeout = None
+
 # Stream g-code to grbl
 for line in f:
     l = line.strip() # Strip all EOL characters for consistency
@@ -11,6 +11,8 @@ response from the computer. This effectively adds another
 buffer layer to prevent buffer starvation.
 
 CHANGELOG:
+- 20261018: Optional baud rate switch via the '$B=' command before
+    streaming. Falls back to the initial rate if Grbl refuses it.
 - 20170531: Status report feedback at 1.0 second intervals.
     Configurable baudrate and report intervals. Bug fixes.
 - 20161212: Added push message feedback for simple streaming
@@ -71,6 +73,10 @@ parser.add_argument('-s','--settings',action='store_true', default=False,
         help='settings write mode')        
 parser.add_argument('-c','--check',action='store_true', default=False,
         help='stream in check mode')
+parser.add_argument('-b','--baud',type=int,default=BAUD_RATE,
+        help='initial baud rate, as compiled into Grbl')
+parser.add_argument('-B','--switch-baud',type=int,default=0,metavar='BAUD',
+        help='switch to this baud rate via $B before streaming, e.g. 250000, 500000 or 1000000')
 args = parser.parse_args()
 
 # Periodic timer to query for status reports
@@ -84,8 +90,35 @@ def periodic_timer() :
       time.sleep(REPORT_INTERVAL)
   
 
+# Switches Grbl and the host port to a new baud rate. Grbl changes rate after receiving the
+# command and waits for a '$B' line at the new rate. Its 'ok' then confirms the link works. If
+# not confirmed in time, Grbl goes back to the old rate and reports an error there.
+def switch_baud(baud):
+    old_baud = s.baudrate
+    print "Switching baud rate: SND: [$B="+str(baud)+"]",
+    s.write("$B="+str(baud)+"\n")
+    s.flush()
+    time.sleep(0.05) # Give Grbl time to switch first.
+    if s.inWaiting() :
+        print "REC:",s.readline().strip() # Refused at the old rate, i.e. unsupported.
+        return False
+    s.baudrate = baud
+    s.flushInput() # Discard anything garbled during the switch.
+    s.timeout = 0.5 # Must be shorter than Grbl's SERIAL_BAUD_CONFIRM_TIMEOUT.
+    s.write("$B\n")
+    grbl_out = s.readline().strip()
+    if grbl_out.find('ok') >= 0 :
+        print "REC:",grbl_out
+        s.timeout = None
+        return True
+    s.baudrate = old_baud
+    s.timeout = 2.0
+    print "REC:",s.readline().strip() # Fallback error at the old rate.
+    s.timeout = None
+    return False
+
 # Initialize
-s = serial.Serial(args.device_file,BAUD_RATE)
+s = serial.Serial(args.device_file,args.baud)
 f = args.gcode_file
 verbose = True
 if args.quiet : verbose = False
@@ -102,6 +135,10 @@ s.write("\r\n\r\n")
 time.sleep(2)
 s.flushInput()
 
+if args.switch_baud :
+    if not switch_baud(args.switch_baud) :
+        print "  Failed to switch baud rate. Streaming at",s.baudrate
+
 if check_mode :
     print "Enabling Grbl Check-Mode: SND: [$C]",
     s.write("$C\n")
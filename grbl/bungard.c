@@ -4,6 +4,7 @@
  *  La communication se fait via un port parallèle standard (data+strobe+status)
  *  D7 définit si l'on commande les PàP ou si l'on modifie l'un des registres de configuration
  *  D6 choisit le registre de configuration "latch1" ou "latch2"
+ *  Voir doc/script/bungard_bus.py pour décoder une capture du bus sur PC.
  */
 
 /* Latch1 = IC3 (40174)
@@ -34,31 +35,31 @@ static uint8_t latch2 = 0; // Cache value of latch2
 
 static uint8_t stepper_limits_override_flag = 0;
 
-#define nop() __asm__("nop\n\t")
+uint8_t bel_step_portb = 0;
+uint8_t bel_step_portd = 0;
+
+// Writes any byte to the bus. Builds the port images from the current non-bus pins, i.e. the limit
+// pull-up and serial pins, with interrupts off, so a step write from the ISR can't interleave with it.
 void bel_write_byte(uint8_t data)
 {
-  // as these bitwise operations are quite slow, we do not need additional delays...
-  PORTB = (PORTB & 0xFC) | data >> 6;
-  PORTD = (PORTD & 0x3) | data << 2;
-  // at least 0.5us per lpt spec
-  nop();nop();nop();nop();
-  // at least 0.5us per lpt spec 
-  PORTB |= 0x20;
-  nop();nop();nop();nop();
-  PORTB &= ~0x20;
+  uint8_t sreg = SREG;
+  cli();
+  bel_write_image((PORTB & ~(BEL_PORTB_DATA_MASK | BEL_STROBE_MASK)) | (data >> 6),
+                  (PORTD & ~BEL_PORTD_DATA_MASK) | (data << 2));
+  SREG = sreg;
 }
 
 void bel_write_latch(uint8_t latch, uint8_t data)
 {
-  // as these bitwise operations are quite slow, we do not need additional delays...
-  PORTB = (PORTB & 0xFC) | latch | 0x2;
-  PORTD = (PORTD & 0x3) | data << 2;
-  // at least 0.5us per lpt spec
-  nop();nop();nop();nop();
-  // at least 0.5us per lpt spec
-  PORTB |= 0x20;
-  nop();nop();nop();nop();
-  PORTB &= ~0x20;
+  bel_write_byte(BEL_LATCH1_WRITE_MASK | (latch << 6) | (data & 0x3F));
+}
+
+// Runs at the end of every stepper ISR tick, off the timing-critical path. The non-bus pins are
+// sampled every time, since limits_init() sets the limit pull-up after the bus is initialized.
+void bel_steppers_prepare(uint8_t data)
+{
+  bel_step_portb = (PORTB & ~(BEL_PORTB_DATA_MASK | BEL_STROBE_MASK)) | (stepper_limits_override_flag >> 6);
+  bel_step_portd = (PORTD & ~BEL_PORTD_DATA_MASK) | (data << 2);
 }
 
 void bel_init()
@@ -79,17 +80,17 @@ void bel_set_steppers_enable(bool enable)
   bel_write_latch(BEL_LATCH2, latch2);
 }
 
-void bel_steppers_step(uint8_t data)
-{
-  bel_write_byte(data & 0x3F | stepper_limits_override_flag);
-}
-
 void bel_set_steppers_limit_override_enable(bool enable)
 {
   if (enable)
     stepper_limits_override_flag = 0x40;
   else
     stepper_limits_override_flag = 0;
+  // Keep a prepared step byte in line. Only D6 changes.
+  uint8_t sreg = SREG;
+  cli();
+  bel_step_portb = (bel_step_portb & ~BEL_PORTB_DATA_MASK) | (stepper_limits_override_flag >> 6);
+  SREG = sreg;
 }
 
 
@@ -133,3 +134,7 @@ bool bel_get_spindle_enable()
   return latch1 & BEL_SPINDLE_ENABLE_MASK;
 }
 
+uint8_t bel_get_spindle_speed()
+{
+  return latch1 & BEL_SPINDLE_SPEED_MASK;
+}
@@ -1,15 +1,48 @@
 #ifndef _BUNGARD_H
 #define _BUNGARD_H
 
+// Bus pins. D0-D5 are PD2-PD7, D6-D7 are PB0-PB1 and the strobe is PB5.
+#define BEL_PORTB_DATA_MASK 0x03
+#define BEL_PORTD_DATA_MASK 0xFC
+#define BEL_STROBE_MASK 0x20
+
+// LPT timing. Data setup before and strobe width are both at least 0.5us.
+#define BEL_SETUP_US 0.5
+#define BEL_STROBE_US 0.5
+
+// Port images of the next step byte, prepared by bel_steppers_prepare() during the previous tick.
+extern uint8_t bel_step_portb;
+extern uint8_t bel_step_portd;
+
+// Writes complete port images to the bus and strobes it. Compiles to two OUTs, a fixed cycle delay,
+// and SBI/delay/CBI, so the timing doesn't depend on the compiler: at 16MHz, the data is set up more
+// than 8 cycles (0.5us) before the strobe rises and the strobe stays high for more than 8 cycles. The
+// old read-modify-write sequence only had 4 NOPs on each. The images must have the strobe low.
+static inline void bel_write_image(uint8_t portb, uint8_t portd)
+{
+  PORTD = portd;
+  PORTB = portb;
+  _delay_us(BEL_SETUP_US);
+  PORTB |= BEL_STROBE_MASK;
+  _delay_us(BEL_STROBE_US);
+  PORTB &= ~BEL_STROBE_MASK;
+}
+
+// Writes the step byte prepared for this tick. Called first thing in the stepper ISR.
+static inline void bel_steppers_step_prepared() { bel_write_image(bel_step_portb, bel_step_portd); }
+
+// Prepares the port images of the step byte for the next tick, from the step and direction bits.
+void bel_steppers_prepare(uint8_t data);
+
 void bel_write_byte(uint8_t data);
 void bel_init();
 void bel_set_steppers_enable(bool enable);
-void bel_steppers_step(uint8_t data);
 void bel_set_steppers_limit_override_enable(bool enable);
 void bel_set_spindle_enable(bool enable);
 void bel_set_spindle_speed(uint8_t speed);
 void bel_set_spindle_brake(bool enable);
 bool bel_get_spindle_enable();
+uint8_t bel_get_spindle_speed();
 
 
 #endif
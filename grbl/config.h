@@ -37,7 +37,12 @@
 #define DEFAULTS_GENERIC
 #define CPU_MAP_ATMEGA328P // Arduino Uno CPU
 
-// Serial baud rate
+// Serial baud rate. At 16MHz, 250000, 500000 and 1000000 divide the clock exactly and have no
+// baud rate error. 115200 is off by 2.1% and 230400 by 3.5%, which some USB-serial chips won't
+// tolerate. A compiler warning is issued, if the selected rate exceeds SERIAL_BAUD_MAX_ERROR.
+// #define BAUD_RATE 1000000
+// #define BAUD_RATE 500000
+// #define BAUD_RATE 250000
 // #define BAUD_RATE 230400
 #define BAUD_RATE 115200
 
@@ -87,6 +92,35 @@
 // mainly a safety feature to remind the user to home, since position is unknown to Grbl.
 #define HOMING_INIT_LOCK // Comment to disable
 
+// Keeps the machine position through a hardware, watchdog or serial DTR reset, if the machine was at
+// rest after a controlled stop, i.e. a completed motion, feed hold or homing cycle. The position is
+// held in uninitialized RAM with a validity token, which is cleared whenever motion starts or an
+// alarm or sleep occurs. If valid after a reset, the position is restored, '[MSG:Pos restored]' is
+// reported, and the homing and initialization alarm locks are skipped. A power cycle always loses it.
+// NOTE: Assumes the stepper drivers hold their position through the controller reset.
+// #define ENABLE_POSITION_RESTORE // Default disabled. Uncomment to enable.
+
+// Compensates leadscrew backlash with the per-axis settings $140-$142 (mm). Whenever an axis reverses,
+// the planner adds the backlash steps to that axis of the reversing block itself, so no separate
+// correction move and no extra stop is needed. The stepper executes them first on that axis and
+// doesn't count them into the machine position, and the planner position skips them as well, so
+// neither the g-code parser nor the position reports see them. Zero values disable it per axis.
+// NOTE: Homing and parking motions are not compensated. Homing sets the position afterwards.
+#define ENABLE_BACKLASH_COMPENSATION // Default enabled. Comment to disable.
+
+// A feed hold normally starts decelerating only after the step segments already prepared at cruise
+// speed have executed, which is up to SEGMENT_BUFFER_SIZE-1 segments of 1/ACCELERATION_TICKS_PER_SECOND
+// each. This drops the queued segments of the block being prepared, except the executing segment and
+// the one after it, and returns their steps to the planner block, so the hold ramp starts at the end of
+// the next segment and the machine stops in a shorter distance. The kept segment covers the time
+// needed to prepare the deceleration.
+#define ENABLE_FAST_FEED_HOLD // Default enabled. Comment to disable.
+
+// Reports the time and travel from a feed hold or safety door request until the machine is at rest,
+// as a '[HOLD:ms,distance]' feedback message when the hold completes. The distance is in mm, or in
+// inches with $13=1. Jog cancels and parking motions are not reported.
+#define REPORT_FEED_HOLD_LATENCY // Default enabled. Comment to disable.
+
 // Define the homing cycle patterns with bitmasks. The homing cycle first performs a search mode
 // to quickly engage the limit switches, followed by a slower locate mode, and finished by a short
 // pull-off motion to disengage the limit switches. The following HOMING_CYCLE_x defines are executed
@@ -112,6 +146,21 @@
 // #define HOMING_CYCLE_0 (1<<X_AXIS)  // COREXY COMPATIBLE: First home X
 // #define HOMING_CYCLE_1 (1<<Y_AXIS)  // COREXY COMPATIBLE: Then home Y
 
+// Bungard CCD homing. The locate phase backs all axes off their switches by this distance and
+// re-touches them at the homing feed rate. It only has to clear the switch hysteresis of the CCD/2,
+// so it is much shorter than the pull-off distance setting.
+#define BUNGARD_HOMING_LOCATE_DISTANCE 0.5 // mm
+
+// Prints the Bungard homing phases and axis locks during '$H'. For debugging only, as the extra
+// messages aren't part of the Grbl interface and may confuse GUIs.
+// #define BUNGARD_HOMING_DEBUG // Default disabled. Uncomment to enable.
+
+// Speeds up repeated homing. If the machine position is still valid from the last homing cycle,
+// '$H' moves directly to near the switches and only verifies them with one locate phase. The
+// position is considered lost on any alarm, sleep or power-up, and whenever the switches aren't
+// found where expected, which falls back to the full homing cycle.
+// #define BUNGARD_HOMING_TRUSTED_POSITION // Default disabled. Uncomment to enable.
+
 // Number of homing cycles performed after when the machine initially jogs to limit switches.
 // This help in preventing overshoot and should improve repeatability. This value should be one or
 // greater.
@@ -163,11 +212,53 @@
 // coordinates through Grbl '$#' print parameters.
 #define MESSAGE_PROBE_COORDINATES // Enabled by default. Comment to disable.
 
+// Enables a two-speed G38.2/G38.3 probe cycle. After the seek touch at the programmed feed rate,
+// the tool backs off by PROBE_LATCH_RETRACT at rapid rate and re-touches at PROBE_LATCH_FEED_RATE.
+// Only the latch touch is recorded and reported. All passes run back to back in the firmware, so
+// accurate Z-zeroing no longer needs a fast and a slow G38 with host round-trips in between. The
+// seek can run much faster, since its overshoot and switch lag no longer affect the result. Also
+// used by the '$P' height map probing. Probing away from the workpiece (G38.4/G38.5) is unchanged.
+// NOTE: A probe still triggered after the back-off raises the probe initial state alarm. If the latch
+// pass misses, G38.2 alarms as usual and G38.3 keeps the seek touch as the probe position.
+// #define ENABLE_PROBE_LATCH // Default disabled. Uncomment to enable.
+#define PROBE_LATCH_RETRACT 0.5 // Back-off distance after the seek touch (mm)
+#define PROBE_LATCH_FEED_RATE 10.0 // Latch pass feed rate (mm/min)
+
+// Enables the '$P' surface height map for PCB milling. '$P=X(len)Y(len)I(nx)J(ny)Z(depth)F(feed)'
+// probes an nx by ny grid of points, starting at the current position and covering X by Y mm in the
+// positive directions. Each point is probed down by up to Z mm from the start height at feed rate F.
+// An optional R(mm) retracts only that far above the last touch, rather than to the start height, when
+// moving between points. The grid is probed in one firmware cycle without host round-trips. Heights
+// are stored in RAM relative to the first point, so Z should be zeroed at the grid origin. Afterwards,
+// all motions pass through a bilinear Z correction and are split at grid cell boundaries. '$P' reports
+// the map and '$P=0' clears it. The map is kept through soft-resets, but not a power cycle.
+// NOTE: Uses 2 bytes of RAM per grid point. Motions outside the grid use the height of the nearest edge.
+#define ENABLE_HEIGHT_MAP // Default enabled. Comment to disable.
+#define HEIGHT_MAP_MAX_POINTS 49 // Max grid points nx*ny. (4-255)
+
+// Enables continuous jogging with '$JC=X..Y..Z..F..'. The axis words give a direction vector, not a
+// target, and F the rate. Grbl generates short rolling jog segments itself and keeps only as many
+// queued as needed to cover the stopping distance, so a jog cancel (0x85) stops the machine as
+// quickly as its acceleration allows, independent of the planner buffer depth. Sending '$JC=' again
+// changes direction or rate, '$JC=F0' ends it. Travel ends at the soft limits, which must be enabled.
+// The host must repeat '$JC=' within JOG_CONTINUOUS_TIMEOUT to keep the jog going, otherwise it ends
+// as with '$JC=F0', so a stalled host or dropped link can't leave the machine running.
+#define ENABLE_CONTINUOUS_JOG // Default enabled. Comment to disable.
+#define JOG_CONTINUOUS_SEGMENT_TIME 50 // Duration of a rolling jog segment at full rate. (ms)
+#define JOG_CONTINUOUS_TIMEOUT 500 // Deadman timeout between '$JC=' commands. (ms)
+
 // Enables a second coolant control pin via the mist coolant g-code command M7 on the Arduino Uno
 // analog pin 4. Only use this option if you require a second coolant control pin.
 // NOTE: The M8 flood coolant control pin on analog pin 3 will still be functional regardless.
 // #define ENABLE_M7 // Disabled by default. Uncomment to enable.
 
+// Queues M7, M8 and M9 with motion instead of forcing a planner buffer sync. The planner blocks already
+// carry the coolant state. The stepper ISR switches the outputs when the first segment of a block that
+// changes it is loaded, so coolant follows the program at the exact block boundary without stopping.
+// A change that no later block carries is applied once the buffer has run empty.
+// NOTE: Spindle changes still sync, since the CCD/2 spindle start sequence runs on the main program.
+#define ENABLE_QUEUED_COOLANT // Default enabled. Comment to disable.
+
 // This option causes the feed hold input to act as a safety door switch. A safety door, when triggered,
 // immediately forces a feed hold and then safely de-energizes the machine. Resuming is blocked until
 // the safety door is re-engaged. When it is, Grbl will re-energize the machine and then resume on the
@@ -296,6 +387,19 @@
 // certain the step segment buffer is increased/decreased to account for these changes.
 #define ACCELERATION_TICKS_PER_SECOND 100
 
+// Sizes the step segments by the velocity profile instead of a fixed 1/ACCELERATION_TICKS_PER_SECOND.
+// Segments starting on an acceleration or deceleration ramp are RAMP_SEGMENT_DIVISOR times shorter, for
+// a finer velocity staircase. Cruise segments are CRUISE_SEGMENT_MULTIPLIER times longer, since a constant
+// speed needs no resolution and every segment costs a full floating point prep pass. A cruise segment
+// ends where the deceleration starts, so ramps always begin on a short segment. The ramp segments must
+// leave the segment buffer with at least 20ms of motion, and the cruise segments at most 100ms, which is
+// checked at compile time.
+// NOTE: Feed overrides take effect only after the queued segments, so long cruise segments delay them
+// accordingly. ENABLE_FAST_FEED_HOLD splits the cruise segment following the executing one for holds.
+#define ADAPTIVE_SEGMENT_TIMING // Default enabled. Comment to disable.
+#define RAMP_SEGMENT_DIVISOR 2 // Integer (1-4) Above 2 requires a larger SEGMENT_BUFFER_SIZE.
+#define CRUISE_SEGMENT_MULTIPLIER 2 // Integer (1-4) Above 2 requires a smaller SEGMENT_BUFFER_SIZE.
+
 // Adaptive Multi-Axis Step Smoothing (AMASS) is an advanced feature that does what its name implies,
 // smoothing the stepping of multi-axis motions. This feature smooths motion particularly at low step
 // frequencies below 10kHz, where the aliasing between axes of multi-axis motions can cause audible
@@ -303,6 +407,22 @@
 // step smoothing. See stepper.c for more details on the AMASS system works.
 #define ADAPTIVE_MULTI_AXIS_STEP_SMOOTHING  // Default enabled. Comment to disable.
 
+// AMASS depth and ISR budget. Each AMASS level doubles the ISR over-drive and halves the cutoff frequency
+// of the level before it, starting at AMASS_ISR_FREQUENCY/2 for level 1, so the ISR never ticks faster than
+// AMASS_ISR_FREQUENCY while smoothing. Stock Grbl stops at level 3 (2kHz), below which the step timing falls
+// back to the bare Timer1 interval and slow multi-axis moves, like PCB drilling plunges, alias again.
+// Levels 4 and 5 smooth down to 1kHz and 500Hz at no extra ISR load at high speeds. Set the ISR frequency
+// from the worst-case stepper ISR time measured on this build, leaving room for the serial and bus traffic.
+#define MAX_AMASS_LEVEL 5 // Integer (1-5)
+#define AMASS_ISR_FREQUENCY 16000 // ISR over-drive budget (Hz)
+
+// Profiles the execution time of the stepper ISR. Each step tick records the Timer1 count at its end,
+// which is the time since the compare match that started it, including interrupt latency. Min, average
+// and maximum, an 8-bin histogram in 4us steps, and the ticks skipped by the busy flag or finished
+// after the next tick was due, are reported by '$T' in any state. '$T=0' clears them.
+// NOTE: Adds roughly 6us to every ISR tick. Requires AMASS, which keeps Timer1 at the CPU clock.
+// #define ENABLE_STEPPER_ISR_PROFILER // Default disabled. Uncomment to enable.
+
 // Sets the maximum step rate allowed to be written as a Grbl setting. This option enables an error
 // check in the settings module to prevent settings values that will exceed this limitation. The maximum
 // step rate is strictly limited by the CPU speed and will change if something other than an AVR running
@@ -396,6 +516,14 @@
 // bogged down by too many trig calculations.
 #define N_ARC_CORRECTION 12 // Integer (1-255)
 
+// Minimum duration of an arc chord at the programmed feed rate. Overrides the arc tolerance ($12).
+// Grbl needs a few milliseconds to generate and plan each chord. On small radii at high feed rates,
+// the arc tolerance would give chords shorter than that, starving the planner and stuttering the
+// motion. A non-zero value lengthens such chords to this duration, which deviates from the arc by
+// more than $12 and trades path accuracy for a smooth feed. 3.0ms is a sensible value, if wanted.
+// The default of zero always honors the arc tolerance.
+#define ARC_MIN_CHORD_TIME 0.0 // Float (ms) Zero disables.
+
 // The arc G2/3 g-code standard is problematic by definition. Radius-based arcs have horrible numerical
 // errors when arc at semi-circles(pi) or full-circles(2*pi). Offset-based arcs are much more accurate
 // but still have a problem when arcs are full-circles (2*pi). This define accounts for the floating
@@ -406,13 +534,6 @@
 // much greater than this. The default setting should capture most, if not all, full arc error situations.
 #define ARC_ANGULAR_TRAVEL_EPSILON 5E-7 // Float (radians)
 
-// Time delay increments performed during a dwell. The default value is set at 50ms, which provides
-// a maximum time delay of roughly 55 minutes, more than enough for most any application. Increasing
-// this delay will increase the maximum dwell time linearly, but also reduces the responsiveness of
-// run-time command executions, like status reports, since these are performed between each dwell
-// time step. Also, keep in mind that the Arduino delay timer is not very accurate for long delays.
-#define DWELL_TIME_STEP 50 // Integer (1-255) (milliseconds)
-
 // Creates a delay between the direction pin setting and corresponding step pulse by creating
 // another interrupt (Timer2 compare) to manage it. The main Grbl interrupt (Timer1 compare)
 // sets the direction pins, and does not immediately set the stepper pins, as it would in
@@ -462,6 +583,28 @@
 // #define RX_BUFFER_SIZE 128 // (1-254) Uncomment to override defaults in serial.h
 // #define TX_BUFFER_SIZE 100 // (1-254)
 
+// Sizes the serial RX buffer and the planner buffer at power-up from the free SRAM, rather than using
+// their fixed defaults above. Both are carved from the region between the end of the static variables
+// (__heap_start) and the stack, less BUFFER_STACK_RESERVE bytes kept for the stack. RAM freed by
+// disabling an option, or taken by enabling one, goes to or comes from buffering without retuning.
+// The policy decides which buffer keeps its default size while the other takes the rest:
+// BUFFER_BUDGET_PLANNER grows the planner look-ahead (limited to 255 blocks), BUFFER_BUDGET_RX grows
+// the RX buffer for character-counting streamers (limited to 254). Neither goes below 8 blocks or 64
+// bytes, even if that cuts into the stack reserve. The step segment buffer stays static at its
+// SEGMENT_BUFFER_SIZE, since its size sets the buffered step time, which is bounded at compile time.
+// The resulting sizes are reported by '$I' in the [OPT:] line as usual. With REPORT_MEMORY_USAGE,
+// '$I' also reports the lowest free stack since reset. Use it to check the stack reserve.
+// NOTE: RX_BUFFER_SIZE and BLOCK_BUFFER_SIZE above must not be defined with this option.
+#define ENABLE_BUFFER_RAM_BUDGET // Default enabled. Comment to disable.
+#define BUFFER_STACK_RESERVE 400 // Bytes of SRAM kept free for the stack.
+#define BUFFER_BUDGET_PLANNER 0
+#define BUFFER_BUDGET_RX 1
+#define BUFFER_BUDGET_POLICY BUFFER_BUDGET_PLANNER // BUFFER_BUDGET_PLANNER or BUFFER_BUDGET_RX
+
+// Paints unused SRAM at power-up and reports the buffer sizes, their RAM use and the lowest stack
+// headroom reached since power-up in a [MEM:] line of the '$I' build info.
+#define REPORT_MEMORY_USAGE // Default enabled. Comment to disable.
+
 // A simple software debouncing feature for hard limit switches. When enabled, the interrupt 
 // monitoring the hard limit switch pins will enable the Arduino's watchdog timer to re-check 
 // the limit pin state after a delay of about 32msec. This can help with CNC machines with 
@@ -519,6 +662,15 @@
 // NOTE: See the included grblWrite_BuildInfo.ino example file to write this string seperately.
 #define ENABLE_BUILD_INFO_WRITE_COMMAND // '$I=' Default enabled. Comment to disable.
 
+// Enables the '$B=(baud)' command, which lets a sender switch to a faster baud rate at runtime,
+// while keeping BAUD_RATE as a safe power-up default. Grbl switches after the command is received
+// and then waits SERIAL_BAUD_CONFIRM_TIMEOUT for the sender to send '$B' at the new rate. Without
+// this confirmation, e.g. the link can't run at that rate, Grbl falls back to the previous rate and
+// reports an error there. Rates with more than SERIAL_BAUD_MAX_ERROR error are refused. The rate
+// persists through soft-resets, but not a power cycle or a hardware reset via DTR.
+#define ENABLE_BAUD_RATE_COMMAND // '$B=' Default enabled. Comment to disable.
+#define SERIAL_BAUD_CONFIRM_TIMEOUT 1000 // Milliseconds (0-65535)
+
 // AVR processors require all interrupts to be disabled during an EEPROM write. This includes both
 // the stepper ISRs and serial comm ISRs. In the event of a long EEPROM write, this ISR pause can
 // cause active stepping to lose position and serial receive data to be lost. This configuration
@@ -531,8 +683,26 @@
 // NOTE: Most EEPROM write commands are implicitly blocked during a job (all '$' commands). However,
 // coordinate set g-code commands (G10,G28/30.1) are not, since they are part of an active streaming
 // job. At this time, this option only forces a planner buffer sync with these g-code commands.
+// NOTE: With ENABLE_EEPROM_WRITE_QUEUE below, EEPROM writes no longer disable interrupts, and this
+// option may be disabled.
 #define FORCE_BUFFER_SYNC_DURING_EEPROM_WRITE // Default enabled. Comment to disable.
 
+// Writes the EEPROM in the background. eeprom_put_char() queues the bytes and the EEPROM ready interrupt
+// programs them one by one, about 3.4ms each, with interrupts enabled. Settings, coordinate data and
+// startup line writes then no longer stall the stepper and serial interrupts, and the coordinate data
+// write-back no longer waits for the machine to be idle. Reads wait for queued writes to complete.
+// NOTE: A write only waits while the queue is full. The queue costs 3 bytes of RAM per entry.
+#define ENABLE_EEPROM_WRITE_QUEUE // Default enabled. Comment to disable.
+#define EEPROM_QUEUE_SIZE 16 // Queued bytes (14-255). Holds one less. A coordinate data set needs 13.
+
+// Keeps a RAM copy of all coordinate data sets (G54-G59, G28, G30), loaded once at power up. Coordinate
+// system selects, G28/G30 and the '$#' report no longer read the EEPROM. G10 and G28.1/G30.1 update the
+// copy right away, while its EEPROM write-back is deferred until the machine is idle, or to the main
+// loop with the EEPROM write queue. These commands no longer force a buffer sync for the EEPROM write.
+// Costs 96 bytes of RAM.
+// NOTE: A change not yet written back is lost on a power cycle or hardware reset during the job.
+#define ENABLE_COORD_DATA_CACHE // Default enabled. Comment to disable.
+
 // In Grbl v0.9 and prior, there is an old outstanding bug where the `WPos:` work position reported
 // may not correlate to what is executing, because `WPos:` is based on the g-code parser state, which
 // can be several motions behind. This option forces the planner buffer to empty, sync, and stop
@@ -610,6 +780,33 @@
 #define RPM_LINE_A4  1.203413e-01  // Used N_PIECES = 4. A and B constants of line 4.
 #define RPM_LINE_B4  1.151360e+03
 
+// Enables the '%' program delimiter. A '%' received on its own line toggles program mode, which tells
+// Grbl that a job is being streamed rather than commands being typed in by hand. While in program mode,
+// an empty serial RX buffer is treated as a streaming hiccup and not as the end of the program, so the
+// auto-cycle start is held off until the planner buffer is full, the input has been quiet for the
+// delay below, or the closing '%' arrives. Non-critical buffer syncs are also skipped, i.e. spindle
+// and coolant commands that don't change the outputs and zero-length G4 dwells, so re-issued M3/S
+// words in CAM output no longer stop the machine. A soft-reset always exits program mode.
+// NOTE: Any command that must wait for motion to finish still syncs the buffer and starts the cycle.
+#define ENABLE_PROGRAM_MODE // Default enabled. Comment to disable.
+#define PROGRAM_MODE_START_DELAY 100 // Integer (1-255) (milliseconds)
+
+// Enables a fast path in the g-code parser for the most common lines in PCB jobs: G0/G1 motions
+// with only X, Y, Z and F words, either explicit (`G1X1.2Y3.4`) or under the active motion mode
+// (`X1.2Y3.4`). These skip the full parser block setup and modal group error-checking and go
+// straight to mc_line(). Any other line, or a line that would raise an error, falls back to the
+// full parser, so behavior and error reporting are unchanged. Inverse time and laser modes always
+// use the full parser. Costs a few hundred bytes of flash.
+#define ENABLE_GCODE_FAST_PATH // Default enabled. Comment to disable.
+
+// Runs the g-code fast path above in fixed-point. Axis words are read directly into integers of
+// 0.1 micron (or 0.0001 inch) resolution, and the work coordinate, G92 and tool length offsets are
+// applied with integer math. Consecutive fast path lines, like long G91 incremental chains, then
+// accumulate no floating point rounding error, and a few soft-float operations per axis are saved.
+// The result is converted to a float target only once, when passed to the planner.
+// NOTE: Requires ENABLE_GCODE_FAST_PATH. Values are limited to about +/-200 meters.
+#define ENABLE_GCODE_FIXED_POINT // Default enabled. Comment to disable.
+
 
 /* ---------------------------------------------------------------------------------------
    OEM Single File Configuration Option
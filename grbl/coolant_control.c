@@ -20,6 +20,10 @@
 
 #include "grbl.h"
 
+#ifdef ENABLE_QUEUED_COOLANT
+  static uint8_t coolant_pending; // Flags a queued coolant change for coolant_apply_pending().
+#endif
+
 
 void coolant_init()
 {
@@ -28,6 +32,9 @@ void coolant_init()
     COOLANT_MIST_DDR |= (1 << COOLANT_MIST_BIT);
   #endif
   coolant_stop();
+  #ifdef ENABLE_QUEUED_COOLANT
+    coolant_pending = false;
+  #endif
 }
 
 
@@ -74,10 +81,10 @@ void coolant_stop()
 }
 
 
-// Main program only. Immediately sets flood coolant running state and also mist coolant, 
-// if enabled. Also sets a flag to report an update to a coolant state.
-// Called by coolant toggle override, parking restore, parking retract, sleep mode, g-code
-// parser program end, and g-code parser coolant_sync().
+// Immediately sets flood coolant running state and also mist coolant, if enabled. Also sets a
+// flag to report an update to a coolant state. Called by coolant toggle override, parking restore,
+// parking retract, sleep mode, g-code parser program end, and g-code parser coolant_sync(). With
+// queued coolant, also called by the stepper ISR at the start of a block that changes the state.
 void coolant_set_state(uint8_t mode)
 {
   if (sys.abort) { return; } // Block during abort.  
@@ -113,9 +120,41 @@ void coolant_set_state(uint8_t mode)
 
 // G-code parser entry-point for setting coolant state. Forces a planner buffer sync and bails 
 // if an abort or check-mode is active.
+// NOTE: With queued coolant, there is no sync. The change rides along with the next planner blocks
+// and is applied by the stepper ISR. Only when there is no motion to wait for, it is set right away.
+// Pending arc chords are queued first, so the cycle stop of a planner starved mid-arc can't apply
+// the change before the arc is done.
 void coolant_sync(uint8_t mode)
 {
   if (sys.state == STATE_CHECK_MODE) { return; }
-  protocol_buffer_synchronize(); // Ensure coolant turns on when specified in program.
-  coolant_set_state(mode);
+  #ifdef ENABLE_QUEUED_COOLANT
+    mc_arc_finish();
+    if ((sys.state == STATE_IDLE) && (plan_get_current_block() == NULL)) { coolant_set_state(mode); }
+    else { coolant_pending = true; }
+  #else
+    #ifdef ENABLE_PROGRAM_MODE
+      // In program mode, skip the sync if the coolant outputs already match the requested state.
+      if (sys.program_mode) {
+        uint8_t cl_state = coolant_get_state();
+        if (mode == COOLANT_DISABLE) {
+          if (cl_state == COOLANT_STATE_DISABLE) { return; }
+        } else if ((cl_state & mode) == mode) { return; }
+      }
+    #endif
+    protocol_buffer_synchronize(); // Ensure coolant turns on when specified in program.
+    coolant_set_state(mode);
+  #endif
 }
+
+
+#ifdef ENABLE_QUEUED_COOLANT
+  // Applies a queued coolant change, which no planner block has carried to the outputs, once the
+  // motion is complete. Called by the main program at cycle stop.
+  void coolant_apply_pending()
+  {
+    if (coolant_pending) {
+      coolant_pending = false;
+      coolant_set_state(gc_state.modal.coolant);
+    }
+  }
+#endif
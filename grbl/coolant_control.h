@@ -44,4 +44,9 @@ void coolant_set_state(uint8_t mode);
 // G-code parser entry-point for setting coolant states. Checks for and executes additional conditions.
 void coolant_sync(uint8_t mode);
 
+#ifdef ENABLE_QUEUED_COOLANT
+  // Applies a queued coolant change not carried by any planner block. Called at cycle stop.
+  void coolant_apply_pending();
+#endif
+
 #endif
@@ -41,6 +41,9 @@
   #define DEFAULT_X_MAX_TRAVEL 200.0 // mm NOTE: Must be a positive value.
   #define DEFAULT_Y_MAX_TRAVEL 200.0 // mm NOTE: Must be a positive value.
   #define DEFAULT_Z_MAX_TRAVEL 200.0 // mm NOTE: Must be a positive value.
+  #define DEFAULT_X_BACKLASH 0.0 // mm
+  #define DEFAULT_Y_BACKLASH 0.0 // mm
+  #define DEFAULT_Z_BACKLASH 0.0 // mm
   #define DEFAULT_SPINDLE_RPM_MAX 60000.0 // rpm
   #define DEFAULT_SPINDLE_RPM_MIN 30000.0 // rpm
   #define DEFAULT_STEP_PULSE_MICROSECONDS 10
@@ -83,6 +86,9 @@
   #define DEFAULT_X_MAX_TRAVEL 225.0 // mm NOTE: Must be a positive value.
   #define DEFAULT_Y_MAX_TRAVEL 125.0 // mm NOTE: Must be a positive value.
   #define DEFAULT_Z_MAX_TRAVEL 170.0 // mm NOTE: Must be a positive value.
+  #define DEFAULT_X_BACKLASH 0.0 // mm
+  #define DEFAULT_Y_BACKLASH 0.0 // mm
+  #define DEFAULT_Z_BACKLASH 0.0 // mm
   #define DEFAULT_SPINDLE_RPM_MAX 2800.0 // rpm
   #define DEFAULT_SPINDLE_RPM_MIN 0.0 // rpm
   #define DEFAULT_STEP_PULSE_MICROSECONDS 10
@@ -121,6 +127,9 @@
   #define DEFAULT_X_MAX_TRAVEL 225.0 // mm NOTE: Must be a positive value.
   #define DEFAULT_Y_MAX_TRAVEL 125.0 // mm NOTE: Must be a positive value.
   #define DEFAULT_Z_MAX_TRAVEL 170.0 // mm NOTE: Must be a positive value.
+  #define DEFAULT_X_BACKLASH 0.0 // mm
+  #define DEFAULT_Y_BACKLASH 0.0 // mm
+  #define DEFAULT_Z_BACKLASH 0.0 // mm
   #define DEFAULT_SPINDLE_RPM_MAX 7000.0 // rpm
   #define DEFAULT_SPINDLE_RPM_MIN 0.0 // rpm
   #define DEFAULT_STEP_PULSE_MICROSECONDS 10
@@ -166,6 +175,9 @@
   #define DEFAULT_X_MAX_TRAVEL 200.0 // mm NOTE: Must be a positive value.
   #define DEFAULT_Y_MAX_TRAVEL 200.0 // mm NOTE: Must be a positive value.
   #define DEFAULT_Z_MAX_TRAVEL 200.0 // mm NOTE: Must be a positive value.
+  #define DEFAULT_X_BACKLASH 0.0 // mm
+  #define DEFAULT_Y_BACKLASH 0.0 // mm
+  #define DEFAULT_Z_BACKLASH 0.0 // mm
   #define DEFAULT_SPINDLE_RPM_MAX 10000.0 // rpm
   #define DEFAULT_SPINDLE_RPM_MIN 0.0 // rpm
   #define DEFAULT_STEP_PULSE_MICROSECONDS 10
@@ -211,6 +223,9 @@
   #define DEFAULT_X_MAX_TRAVEL 290.0 // mm NOTE: Must be a positive value.
   #define DEFAULT_Y_MAX_TRAVEL 290.0 // mm NOTE: Must be a positive value.
   #define DEFAULT_Z_MAX_TRAVEL 100.0 // mm NOTE: Must be a positive value.
+  #define DEFAULT_X_BACKLASH 0.0 // mm
+  #define DEFAULT_Y_BACKLASH 0.0 // mm
+  #define DEFAULT_Z_BACKLASH 0.0 // mm
   #define DEFAULT_SPINDLE_RPM_MAX 10000.0 // rpm
   #define DEFAULT_SPINDLE_RPM_MIN 0.0 // rpm
   #define DEFAULT_STEP_PULSE_MICROSECONDS 10
@@ -255,6 +270,9 @@
   #define DEFAULT_X_MAX_TRAVEL 425.0 // mm NOTE: Must be a positive value.
   #define DEFAULT_Y_MAX_TRAVEL 465.0 // mm NOTE: Must be a positive value.
   #define DEFAULT_Z_MAX_TRAVEL 80.0 // mm NOTE: Must be a positive value.
+  #define DEFAULT_X_BACKLASH 0.0 // mm
+  #define DEFAULT_Y_BACKLASH 0.0 // mm
+  #define DEFAULT_Z_BACKLASH 0.0 // mm
   #define DEFAULT_SPINDLE_RPM_MAX 10000.0 // rpm
   #define DEFAULT_SPINDLE_RPM_MIN 0.0 // rpm
   #define DEFAULT_STEP_PULSE_MICROSECONDS 10
@@ -300,6 +318,9 @@
   #define DEFAULT_X_MAX_TRAVEL 290.0 // mm NOTE: Must be a positive value.
   #define DEFAULT_Y_MAX_TRAVEL 290.0 // mm NOTE: Must be a positive value.
   #define DEFAULT_Z_MAX_TRAVEL 100.0 // mm NOTE: Must be a positive value.
+  #define DEFAULT_X_BACKLASH 0.0 // mm
+  #define DEFAULT_Y_BACKLASH 0.0 // mm
+  #define DEFAULT_Z_BACKLASH 0.0 // mm
   #define DEFAULT_SPINDLE_RPM_MAX 10000.0 // rpm
   #define DEFAULT_SPINDLE_RPM_MIN 0.0 // rpm
   #define DEFAULT_STEP_PULSE_MICROSECONDS 10
@@ -345,6 +366,9 @@
   #define DEFAULT_X_MAX_TRAVEL 740.0 // mm NOTE: Must be a positive value.
   #define DEFAULT_Y_MAX_TRAVEL 790.0 // mm NOTE: Must be a positive value.
   #define DEFAULT_Z_MAX_TRAVEL 100.0 // mm NOTE: Must be a positive value.
+  #define DEFAULT_X_BACKLASH 0.0 // mm
+  #define DEFAULT_Y_BACKLASH 0.0 // mm
+  #define DEFAULT_Z_BACKLASH 0.0 // mm
   #define DEFAULT_SPINDLE_RPM_MAX 10000.0 // rpm
   #define DEFAULT_SPINDLE_RPM_MIN 0.0 // rpm
   #define DEFAULT_STEP_PULSE_MICROSECONDS 10
@@ -388,6 +412,9 @@
   #define DEFAULT_X_MAX_TRAVEL 190.0 // mm NOTE: Must be a positive value.
   #define DEFAULT_Y_MAX_TRAVEL 180.0 // mm NOTE: Must be a positive value.
   #define DEFAULT_Z_MAX_TRAVEL 150.0 // mm NOTE: Must be a positive value.
+  #define DEFAULT_X_BACKLASH 0.0 // mm
+  #define DEFAULT_Y_BACKLASH 0.0 // mm
+  #define DEFAULT_Z_BACKLASH 0.0 // mm
   #define DEFAULT_SPINDLE_RPM_MAX 10000.0 // rpm
   #define DEFAULT_SPINDLE_RPM_MIN 0.0 // rpm
   #define DEFAULT_STEP_PULSE_MICROSECONDS 10
@@ -427,6 +454,9 @@
   #define DEFAULT_X_MAX_TRAVEL 500.0 // mm NOTE: Must be a positive value.
   #define DEFAULT_Y_MAX_TRAVEL 750.0 // mm NOTE: Must be a positive value.
   #define DEFAULT_Z_MAX_TRAVEL 80.0 // mm NOTE: Must be a positive value.
+  #define DEFAULT_X_BACKLASH 0.0 // mm
+  #define DEFAULT_Y_BACKLASH 0.0 // mm
+  #define DEFAULT_Z_BACKLASH 0.0 // mm
   #define DEFAULT_SPINDLE_RPM_MAX 1000.0 // rpm
   #define DEFAULT_SPINDLE_RPM_MIN 0.0 // rpm
   #define DEFAULT_STEP_PULSE_MICROSECONDS 10
@@ -466,6 +496,9 @@
   #define DEFAULT_X_MAX_TRAVEL 1000.0 // mm NOTE: Must be a positive value.
   #define DEFAULT_Y_MAX_TRAVEL 1000.0 // mm NOTE: Must be a positive value.
   #define DEFAULT_Z_MAX_TRAVEL 1000.0 // mm NOTE: Must be a positive value.
+  #define DEFAULT_X_BACKLASH 0.0 // mm
+  #define DEFAULT_Y_BACKLASH 0.0 // mm
+  #define DEFAULT_Z_BACKLASH 0.0 // mm
   #define DEFAULT_SPINDLE_RPM_MAX 1000.0 // rpm
   #define DEFAULT_SPINDLE_RPM_MIN 0.0 // rpm
   #define DEFAULT_STEP_PULSE_MICROSECONDS 10
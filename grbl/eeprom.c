@@ -21,8 +21,7 @@
 *                         $Revision: 1.6 $
 *                         $Date: Friday, February 11, 2005 07:16:44 UTC $
 ****************************************************************************/
-#include <avr/io.h>
-#include <avr/interrupt.h>
+#include "grbl.h"
 
 /* These EEPROM bits have different names on different devices. */
 #ifndef EEPE
@@ -37,6 +36,14 @@
 /* Define to reduce code size. */
 #define EEPROM_IGNORE_SELFPROG //!< Remove SPM flag polling.
 
+#ifdef ENABLE_EEPROM_WRITE_QUEUE
+/* Background write queue of address and data bytes. Emptied by the EEPROM ready interrupt. */
+static unsigned int eeprom_queue_addr[EEPROM_QUEUE_SIZE];
+static unsigned char eeprom_queue_data[EEPROM_QUEUE_SIZE];
+static volatile uint8_t eeprom_queue_head;
+static volatile uint8_t eeprom_queue_tail;
+#endif
+
 /*! \brief  Read byte from EEPROM.
  *
  *  This function reads one byte from a given EEPROM address.
@@ -48,41 +55,29 @@
  */
 unsigned char eeprom_get_char( unsigned int addr )
 {
+	#ifdef ENABLE_EEPROM_WRITE_QUEUE
+	if( SREG & (1<<SREG_I) ) {
+		do {} while( eeprom_queue_head != eeprom_queue_tail ); // Wait for queued writes.
+	}
+	#endif
 	do {} while( EECR & (1<<EEPE) ); // Wait for completion of previous write.
 	EEAR = addr; // Set EEPROM address register.
 	EECR = (1<<EERE); // Start EEPROM read operation.
 	return EEDR; // Return the byte read from EEPROM.
 }
 
-/*! \brief  Write byte to EEPROM.
- *
- *  This function writes one byte to a given EEPROM address.
- *  The differences between the existing byte and the new value is used
- *  to select the most efficient EEPROM programming mode.
+/*! \brief  Program byte into EEPROM.
  *
- *  \note  The CPU is halted for 2 clock cycles during EEPROM programming.
- *
- *  \note  When this function returns, the new EEPROM value is not available
- *         until the EEPROM programming time has passed. The EEPE bit in EECR
- *         should be polled to check whether the programming is finished.
+ *  Selects the most efficient EEPROM programming mode and starts it.
+ *  Must be called with interrupts disabled and no write in progress.
  *
- *  \note  The EEPROM_GetChar() function checks the EEPE bit automatically.
- *
- *  \param  addr  EEPROM address to write to.
- *  \param  new_value  New EEPROM value.
+ *  \note  Clears the EEPROM ready interrupt enable bit.
  */
-void eeprom_put_char( unsigned int addr, unsigned char new_value )
+static void eeprom_program_char( unsigned int addr, unsigned char new_value )
 {
 	char old_value; // Old EEPROM value.
 	char diff_mask; // Difference mask, i.e. old value XOR new value.
 
-	cli(); // Ensure atomic operation for the write operation.
-	
-	do {} while( EECR & (1<<EEPE) ); // Wait for completion of previous write.
-	#ifndef EEPROM_IGNORE_SELFPROG
-	do {} while( SPMCSR & (1<<SELFPRGEN) ); // Wait for completion of SPM.
-	#endif
-	
 	EEAR = addr; // Set EEPROM address register.
 	EECR = (1<<EERE); // Start EEPROM read operation.
 	old_value = EEDR; // Get old EEPROM value.
@@ -120,6 +115,83 @@ void eeprom_put_char( unsigned int addr, unsigned char new_value )
 			EECR |= (1<<EEPE);  // Start Write-only operation.
 		}
 	}
+}
+
+#ifdef ENABLE_EEPROM_WRITE_QUEUE
+/*! \brief  EEPROM ready interrupt.
+ *
+ *  Programs the next queued byte, once the previous write has completed.
+ *  Disables itself when the queue is empty.
+ */
+ISR(EE_READY_vect)
+{
+	uint8_t tail = eeprom_queue_tail;
+	if( tail != eeprom_queue_head ) {
+		eeprom_program_char(eeprom_queue_addr[tail], eeprom_queue_data[tail]);
+		if( ++tail == EEPROM_QUEUE_SIZE ) { tail = 0; }
+		eeprom_queue_tail = tail;
+	}
+	if( tail != eeprom_queue_head ) { EECR |= (1<<EERIE); } // More to write.
+	else { EECR &= ~(1<<EERIE); }
+}
+
+/*! \brief  Free space in the write queue.
+ *
+ *  \return  Number of bytes eeprom_put_char() can queue without waiting.
+ */
+uint8_t eeprom_get_queue_free( void )
+{
+	uint8_t head = eeprom_queue_head; // Copy, since the tail may move under the ISR.
+	uint8_t tail = eeprom_queue_tail;
+	if( head >= tail ) { return((EEPROM_QUEUE_SIZE-1) - (head-tail)); }
+	return((tail-head) - 1);
+}
+#endif
+
+/*! \brief  Write byte to EEPROM.
+ *
+ *  This function writes one byte to a given EEPROM address.
+ *  The differences between the existing byte and the new value is used
+ *  to select the most efficient EEPROM programming mode.
+ *
+ *  \note  The CPU is halted for 2 clock cycles during EEPROM programming.
+ *
+ *  \note  When this function returns, the new EEPROM value is not available
+ *         until the EEPROM programming time has passed. The EEPE bit in EECR
+ *         should be polled to check whether the programming is finished.
+ *
+ *  \note  The EEPROM_GetChar() function checks the EEPE bit automatically.
+ *
+ *  \note  With the write queue, the byte is queued and written by the
+ *         EEPROM ready interrupt in the background, unless interrupts are
+ *         disabled. Waits only while the queue is full.
+ *
+ *  \param  addr  EEPROM address to write to.
+ *  \param  new_value  New EEPROM value.
+ */
+void eeprom_put_char( unsigned int addr, unsigned char new_value )
+{
+#ifdef ENABLE_EEPROM_WRITE_QUEUE
+	if( SREG & (1<<SREG_I) ) {
+		uint8_t next_head = eeprom_queue_head+1;
+		if( next_head == EEPROM_QUEUE_SIZE ) { next_head = 0; }
+		do {} while( next_head == eeprom_queue_tail ); // Wait for room in the queue.
+		eeprom_queue_addr[eeprom_queue_head] = addr;
+		eeprom_queue_data[eeprom_queue_head] = new_value;
+		eeprom_queue_head = next_head;
+		EECR |= (1<<EERIE); // Start writing, if not already.
+		return;
+	}
+#endif
+
+	cli(); // Ensure atomic operation for the write operation.
+	
+	do {} while( EECR & (1<<EEPE) ); // Wait for completion of previous write.
+	#ifndef EEPROM_IGNORE_SELFPROG
+	do {} while( SPMCSR & (1<<SELFPRGEN) ); // Wait for completion of SPM.
+	#endif
+	
+	eeprom_program_char(addr, new_value);
 	
 	sei(); // Restore interrupt flag state.
 }
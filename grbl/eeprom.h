@@ -26,4 +26,9 @@ void eeprom_put_char(unsigned int addr, unsigned char new_value);
 void memcpy_to_eeprom_with_checksum(unsigned int destination, char *source, unsigned int size);
 int memcpy_from_eeprom_with_checksum(char *destination, unsigned int source, unsigned int size);
 
+#ifdef ENABLE_EEPROM_WRITE_QUEUE
+  // Returns the number of bytes that can be written without waiting for the queue.
+  uint8_t eeprom_get_queue_free();
+#endif
+
 #endif
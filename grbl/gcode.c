@@ -36,12 +36,25 @@
 parser_state_t gc_state;
 parser_block_t gc_block;
 
+#ifdef ENABLE_GCODE_FIXED_POINT
+  // Fixed-point copies of the parser position and of the summed work coordinate, G92 and tool
+  // length offsets, in FIXED_POINT_SCALE mm units. Rebuilt from gc_state whenever anything other
+  // than the fast path touches the parser state, so consecutive fast path lines, and in particular
+  // long G91 incremental chains, accumulate no floating point rounding.
+  static uint8_t gc_fixed_valid; // Flags if the fixed-point data below is in sync with gc_state.
+  static int32_t gc_fixed_position[N_AXIS];
+  static int32_t gc_fixed_offset[N_AXIS];
+#endif
+
 #define FAIL(status) return(status);
 
 
 void gc_init()
 {
   memset(&gc_state, 0, sizeof(parser_state_t));
+  #ifdef ENABLE_GCODE_FIXED_POINT
+    gc_fixed_valid = false;
+  #endif
 
   // Load default G54 coordinate system.
   if (!(settings_read_coord_data(gc_state.modal.coord_select,gc_state.coord_system))) {
@@ -50,14 +63,184 @@ void gc_init()
 }
 
 
+#ifdef ENABLE_GCODE_FIXED_POINT
+  // Flags the fixed-point parser data as stale. Called when gc_state.position changes outside the
+  // parser, so the next fast path line rebuilds it.
+  void gc_invalidate_fixed() { gc_fixed_valid = false; }
+#endif
+
+
 // Sets g-code parser position in mm. Input in steps. Called by the system abort and hard
-// limit pull-off routines.
+// limit pull-off routines. The parser position is uncorrected, so with a height map the map Z
+// correction at the current XY is removed. Otherwise the next line would get it twice.
 void gc_sync_position()
 {
   system_convert_array_steps_to_mpos(gc_state.position,sys_position);
+  #ifdef ENABLE_HEIGHT_MAP
+    gc_state.position[Z_AXIS] -= probe_height_map_get_z(gc_state.position[X_AXIS], gc_state.position[Y_AXIS]);
+  #endif
+  #ifdef ENABLE_GCODE_FIXED_POINT
+    gc_fixed_valid = false;
+  #endif
 }
 
 
+#ifdef ENABLE_GCODE_FAST_PATH
+  // Word tracking bits for the fast path. Axis words use their axis index bits.
+  #define FAST_PATH_WORD_F bit(N_AXIS)
+  #define FAST_PATH_WORD_G bit(N_AXIS+1)
+
+  #ifdef ENABLE_GCODE_FIXED_POINT
+    // Returns true, if a fixed-point value is within the range that can't overflow when two are added.
+    static uint8_t gc_fixed_in_range(int32_t value)
+    {
+      return((value <= FIXED_POINT_MAX) && (value >= -FIXED_POINT_MAX));
+    }
+
+
+    // Rebuilds the fixed-point position and offsets from the floating point parser state. Returns
+    // false and leaves them invalid, if any is out of the fixed-point range.
+    static uint8_t gc_fixed_sync()
+    {
+      uint8_t idx;
+      float offset;
+      for (idx=0; idx<N_AXIS; idx++) {
+        offset = gc_state.coord_system[idx] + gc_state.coord_offset[idx];
+        if (idx == TOOL_LENGTH_OFFSET_AXIS) { offset += gc_state.tool_length_offset; }
+        if ((fabs(gc_state.position[idx]) > (float)FIXED_POINT_MAX/FIXED_POINT_SCALE) ||
+            (fabs(offset) > (float)FIXED_POINT_MAX/FIXED_POINT_SCALE)) { return(false); }
+        gc_fixed_position[idx] = lround(gc_state.position[idx]*FIXED_POINT_SCALE);
+        gc_fixed_offset[idx] = lround(offset*FIXED_POINT_SCALE);
+      }
+      gc_fixed_valid = true;
+      return(true);
+    }
+  #endif
+
+  // Executes the most common PCB job block, a G0/G1 motion with only axis words and an optional F
+  // word, without the full parser block setup and modal group checks. Returns false, without
+  // altering any state, if the line contains anything else or would raise an error, so that the
+  // full parser handles it and reports the error as usual. Same input assumptions as gc_execute_line().
+  static uint8_t gc_execute_fast_line(char *line)
+  {
+    // Only plain mm/min feed mode is handled. Inverse time and laser mode need the full parser.
+    if (gc_state.modal.feed_rate != FEED_RATE_MODE_UNITS_PER_MIN) { return(false); }
+    if (bit_istrue(settings.flags,BITFLAG_LASER_MODE)) { return(false); }
+
+    uint8_t motion = gc_state.modal.motion;
+    uint8_t words = 0;
+    uint8_t word_bit;
+    uint8_t char_counter = 0;
+    float xyz[N_AXIS];
+    float feed_rate = gc_state.feed_rate;
+    float value;
+    char letter;
+    #ifdef ENABLE_GCODE_FIXED_POINT
+      int32_t fixed_xyz[N_AXIS];
+    #endif
+
+    while ((letter = line[char_counter]) != 0) {
+      char_counter++;
+      #ifdef ENABLE_GCODE_FIXED_POINT
+        // Axis words are read straight into fixed-point. Never converted through a float.
+        if ((letter >= 'X') && (letter <= 'Z')) {
+          if (!read_fixed(line, &char_counter, &fixed_xyz[letter-'X'])) { return(false); }
+          word_bit = bit(letter-'X');
+          if (words & word_bit) { return(false); }
+          words |= word_bit;
+          continue;
+        }
+      #endif
+      if (!read_float(line, &char_counter, &value)) { return(false); }
+      switch (letter) {
+        case 'G':
+          word_bit = FAST_PATH_WORD_G;
+          if (value == 0.0) { motion = MOTION_MODE_SEEK; }
+          else if (value == 1.0) { motion = MOTION_MODE_LINEAR; }
+          else { return(false); }
+          break;
+        case 'F':
+          word_bit = FAST_PATH_WORD_F;
+          if (value < 0.0) { return(false); }
+          feed_rate = value;
+          if (gc_state.modal.units == UNITS_MODE_INCHES) { feed_rate *= MM_PER_INCH; }
+          break;
+        case 'X': case 'Y': case 'Z':
+          word_bit = bit(letter-'X'); // X_AXIS, Y_AXIS, Z_AXIS
+          xyz[letter-'X'] = value;
+          break;
+        default: return(false);
+      }
+      if (words & word_bit) { return(false); } // Repeated word. Let the full parser report it.
+      words |= word_bit;
+    }
+
+    if (!(words & (bit(X_AXIS)|bit(Y_AXIS)|bit(Z_AXIS)))) { return(false); }
+    if (motion == MOTION_MODE_LINEAR) {
+      if (feed_rate == 0.0) { return(false); } // [Feed rate undefined]
+    } else if (motion != MOTION_MODE_SEEK) { return(false); }
+
+    // Compute the target the same way as the full parser. WPos = MPos - WCS - G92 - TLO.
+    uint8_t idx;
+    #ifdef ENABLE_GCODE_FIXED_POINT
+      if (!gc_fixed_valid) {
+        if (!gc_fixed_sync()) { return(false); }
+      }
+      // Values that could overflow int32 are left to the floating point parser. All axes are checked
+      // before the fixed-point position is updated, so a rejected line leaves no trace.
+      for (idx=0; idx<N_AXIS; idx++) {
+        if (bit_istrue(words,bit(idx))) {
+          if (gc_state.modal.units == UNITS_MODE_INCHES) { // x25.4, rounded to nearest.
+            if ((fixed_xyz[idx] > FIXED_POINT_MAX_INCH) || (fixed_xyz[idx] < -FIXED_POINT_MAX_INCH)) { return(false); }
+            fixed_xyz[idx] = (fixed_xyz[idx]*254 + ((fixed_xyz[idx] < 0) ? -5 : 5))/10;
+          }
+          if (!gc_fixed_in_range(fixed_xyz[idx])) { return(false); }
+          if (gc_state.modal.distance == DISTANCE_MODE_ABSOLUTE) { fixed_xyz[idx] += gc_fixed_offset[idx]; }
+          else { fixed_xyz[idx] += gc_fixed_position[idx]; }
+          if (!gc_fixed_in_range(fixed_xyz[idx])) { return(false); }
+        }
+      }
+      for (idx=0; idx<N_AXIS; idx++) {
+        if (bit_istrue(words,bit(idx))) {
+          gc_fixed_position[idx] = fixed_xyz[idx];
+          xyz[idx] = fixed_xyz[idx]*(1.0/FIXED_POINT_SCALE);
+        } else {
+          xyz[idx] = gc_state.position[idx];
+        }
+      }
+    #else
+    for (idx=0; idx<N_AXIS; idx++) {
+      if (bit_isfalse(words,bit(idx))) {
+        xyz[idx] = gc_state.position[idx];
+      } else {
+        if (gc_state.modal.units == UNITS_MODE_INCHES) { xyz[idx] *= MM_PER_INCH; }
+        if (gc_state.modal.distance == DISTANCE_MODE_ABSOLUTE) {
+          xyz[idx] += gc_state.coord_system[idx] + gc_state.coord_offset[idx];
+          if (idx == TOOL_LENGTH_OFFSET_AXIS) { xyz[idx] += gc_state.tool_length_offset; }
+        } else {
+          xyz[idx] += gc_state.position[idx];
+        }
+      }
+    }
+    #endif
+
+    // Update the parser state and execute. Mirrors steps [1-3,7-8,20] of gc_execute_line().
+    plan_line_data_t plan_data;
+    memset(&plan_data,0,sizeof(plan_line_data_t));
+    gc_state.line_number = 0;
+    gc_state.feed_rate = feed_rate;
+    gc_state.modal.motion = motion;
+    plan_data.feed_rate = feed_rate;
+    plan_data.spindle_speed = gc_state.spindle_speed;
+    plan_data.condition = (gc_state.modal.spindle | gc_state.modal.coolant);
+    if (motion == MOTION_MODE_SEEK) { plan_data.condition |= PL_COND_FLAG_RAPID_MOTION; }
+    mc_line(xyz, &plan_data);
+    memcpy(gc_state.position, xyz, sizeof(xyz));
+    return(true);
+  }
+#endif
+
+
 // Executes one line of 0-terminated G-Code. The line is assumed to contain only uppercase
 // characters and signed floating point values (no whitespace). Comments and block delete
 // characters have been removed. In this function, all units and positions are converted and
@@ -65,6 +248,13 @@ void gc_sync_position()
 // coordinates, respectively.
 uint8_t gc_execute_line(char *line)
 {
+  #ifdef ENABLE_GCODE_FAST_PATH
+    if (gc_execute_fast_line(line)) { return(STATUS_OK); }
+    #ifdef ENABLE_GCODE_FIXED_POINT
+      gc_fixed_valid = false; // The full parser may alter position and offsets. Resync on next fast line.
+    #endif
+  #endif
+
   /* -------------------------------------------------------------------------------------
      STEP 1: Initialize parser block struct and copy current g-code state modes. The parser
      updates these modes and commands as the block line is parser and will only be used and
@@ -967,7 +1157,7 @@ uint8_t gc_execute_line(char *line)
   #endif
 
   // [10. Dwell ]:
-  if (gc_block.non_modal_command == NON_MODAL_DWELL) { mc_dwell(gc_block.values.p); }
+  if (gc_block.non_modal_command == NON_MODAL_DWELL) { mc_dwell(gc_block.values.p, pl_data); }
 
   // [11. Set active plane ]:
   gc_state.modal.plane_select = gc_block.modal.plane_select;
@@ -245,4 +245,9 @@ uint8_t gc_execute_line(char *line);
 // Set g-code parser position. Input in steps.
 void gc_sync_position();
 
+#ifdef ENABLE_GCODE_FIXED_POINT
+  // Marks the fast path's fixed-point position stale after gc_state.position is changed elsewhere.
+  void gc_invalidate_fixed();
+#endif
+
 #endif
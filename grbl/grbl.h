@@ -93,6 +93,14 @@
   #endif
 #endif
 
+#if defined(ENABLE_BACKLASH_COMPENSATION) && defined(COREXY)
+  #error "ENABLE_BACKLASH_COMPENSATION is not supported with COREXY at this time."
+#endif
+
+#if defined(ENABLE_GCODE_FIXED_POINT) && !defined(ENABLE_GCODE_FAST_PATH)
+  #error "ENABLE_GCODE_FIXED_POINT may only be used with ENABLE_GCODE_FAST_PATH enabled"
+#endif
+
 #if defined(SPINDLE_PWM_MIN_VALUE)
   #if !(SPINDLE_PWM_MIN_VALUE > 0)
     #error "SPINDLE_PWM_MIN_VALUE must be greater than zero."
@@ -112,6 +120,34 @@
   #error "Override refresh must be greater than zero."
 #endif
 
+#ifdef ADAPTIVE_MULTI_AXIS_STEP_SMOOTHING
+  #if (MAX_AMASS_LEVEL < 1) || (MAX_AMASS_LEVEL > 5)
+    #error "MAX_AMASS_LEVEL must be within 1 and 5."
+  #endif
+#endif
+
+#if defined(ENABLE_COORD_DATA_CACHE) && defined(ENABLE_EEPROM_WRITE_QUEUE)
+  // The coordinate data write-back waits until a whole set with its checksum fits the queue.
+  #if (EEPROM_QUEUE_SIZE-1 < 4*N_AXIS+1)
+    #error "EEPROM_QUEUE_SIZE too small for a coordinate data set. Increase to at least 4*N_AXIS+2."
+  #endif
+#endif
+
+#if defined(ENABLE_STEPPER_ISR_PROFILER) && !defined(ADAPTIVE_MULTI_AXIS_STEP_SMOOTHING)
+  #error "ENABLE_STEPPER_ISR_PROFILER may only be used with ADAPTIVE_MULTI_AXIS_STEP_SMOOTHING enabled."
+#endif
+
+#ifdef ADAPTIVE_SEGMENT_TIMING
+  // Ramp segments must leave at least 20ms of motion in the segment buffer for the prep to keep up.
+  #if ((SEGMENT_BUFFER_SIZE-1)*1000 < 20*ACCELERATION_TICKS_PER_SECOND*RAMP_SEGMENT_DIVISOR)
+    #error "RAMP_SEGMENT_DIVISOR too high for the segment buffer size. Increase SEGMENT_BUFFER_SIZE."
+  #endif
+  // Cruise segments must not buffer more than 100ms of motion, or feed overrides lag noticeably.
+  #if ((SEGMENT_BUFFER_SIZE-1)*1000*CRUISE_SEGMENT_MULTIPLIER > 100*ACCELERATION_TICKS_PER_SECOND)
+    #error "CRUISE_SEGMENT_MULTIPLIER too high for the segment buffer size. Decrease either."
+  #endif
+#endif
+
 // ---------------------------------------------------------------------------------------
 
 #endif
@@ -31,6 +31,9 @@ uint8_t jog_execute(plan_line_data_t *pl_data, parser_block_t *gc_block)
   #ifdef USE_LINE_NUMBERS
     pl_data->line_number = gc_block->values.n;
   #endif
+  #ifdef ENABLE_CONTINUOUS_JOG
+    sys.jog_continuous = false; // A target jog ends continuous jogging. Queues after its last segment.
+  #endif
 
   if (bit_istrue(settings.flags,BITFLAG_SOFT_LIMIT_ENABLE)) {
     if (system_check_travel_limits(gc_block->values.xyz)) { return(STATUS_TRAVEL_EXCEEDED); }
@@ -48,3 +51,132 @@ uint8_t jog_execute(plan_line_data_t *pl_data, parser_block_t *gc_block)
 
   return(STATUS_OK);
 }
+
+
+#ifdef ENABLE_CONTINUOUS_JOG
+  static float jog_unit_vec[N_AXIS]; // Continuous jog direction.
+  static float jog_rate;             // Continuous jog rate. (mm/min)
+  static float jog_segment_mm;       // Length of one rolling jog segment. (mm)
+  static float jog_remaining_mm;     // Distance left until the travel limit. (mm)
+  static uint8_t jog_horizon;        // Number of planner blocks to keep queued.
+  static uint32_t jog_deadline;      // Deadman timeout. Renewed by every '$JC=' command.
+
+
+  // Sets up or changes a continuous jog from a '$JC=' command line. Axis words give the direction,
+  // which is normalized, and F the rate in the current G20/G21 units. A zero direction or rate ends
+  // the continuous jog, after the few queued segments have run out. Requires soft limits, since the
+  // jog runs unattended up to the travel limits, if the host stops sending.
+  uint8_t jog_continuous_execute(char *line, uint8_t char_counter)
+  {
+    float direction[N_AXIS];
+    float rate = 0.0;
+    float value;
+    char letter;
+    memset(direction, 0, sizeof(direction));
+    while (line[char_counter] != 0) {
+      letter = line[char_counter++];
+      if (!read_float(line, &char_counter, &value)) { return(STATUS_BAD_NUMBER_FORMAT); }
+      switch (letter) {
+        case 'X': direction[X_AXIS] = value; break;
+        case 'Y': direction[Y_AXIS] = value; break;
+        case 'Z': direction[Z_AXIS] = value; break;
+        case 'F': rate = value; break;
+        default: return(STATUS_INVALID_JOG_COMMAND);
+      }
+    }
+    if (rate < 0.0) { return(STATUS_NEGATIVE_VALUE); }
+    if (bit_isfalse(settings.flags,BITFLAG_SOFT_LIMIT_ENABLE)) { return(STATUS_SETTING_DISABLED); }
+
+    uint8_t idx;
+    float magnitude = 0.0;
+    for (idx=0; idx<N_AXIS; idx++) { magnitude += direction[idx]*direction[idx]; }
+    if ((magnitude == 0.0) || (rate == 0.0)) {
+      sys.jog_continuous = false;
+      return(STATUS_OK);
+    }
+    magnitude = sqrt(magnitude);
+    if (gc_state.modal.units == UNITS_MODE_INCHES) { rate *= MM_PER_INCH; }
+
+    // Limit rate and acceleration along the jog direction by the axis maximums, like the planner.
+    float acceleration = SOME_LARGE_VALUE;
+    float inv_unit;
+    for (idx=0; idx<N_AXIS; idx++) {
+      jog_unit_vec[idx] = direction[idx]/magnitude;
+      if (jog_unit_vec[idx] != 0.0) {
+        inv_unit = fabs(1.0/jog_unit_vec[idx]);
+        rate = min(rate, settings.max_rate[idx]*inv_unit);
+        acceleration = min(acceleration, settings.acceleration[idx]*inv_unit);
+      }
+    }
+    float travel = system_get_travel_distance(gc_state.position, jog_unit_vec);
+    if (travel == 0.0) { return(STATUS_TRAVEL_EXCEEDED); }
+
+    // Keep the stopping distance plus the executing segment queued, so the planner can reach the
+    // jog rate. Lengthen the segments, if the planner buffer can't hold enough of them.
+    float stop_mm = rate*rate/(2.0*acceleration);
+    jog_segment_mm = rate*(JOG_CONTINUOUS_SEGMENT_TIME/60000.0);
+    if (stop_mm > (BLOCK_BUFFER_SIZE-2)*jog_segment_mm) {
+      jog_segment_mm = stop_mm/(BLOCK_BUFFER_SIZE-2);
+      jog_horizon = BLOCK_BUFFER_SIZE-1;
+    } else {
+      jog_horizon = ceil(stop_mm/jog_segment_mm)+1;
+    }
+    jog_rate = rate;
+    jog_remaining_mm = travel;
+    jog_deadline = system_set_deadline(JOG_CONTINUOUS_TIMEOUT);
+    sys.jog_continuous = true;
+
+    jog_continuous_update(); // Queue and start immediately.
+    return(STATUS_OK);
+  }
+
+
+  // Queues continuous jog segments, until the planner holds the horizon. The parser position tracks
+  // the last queued segment, so '$J=' and '$JC=' commands continue from there.
+  void jog_continuous_update()
+  {
+    if (!sys.jog_continuous) { return; }
+
+    // End on jog cancel, feed hold, or any other state, i.e. alarm, safety door, or sleep.
+    if ((sys.state != STATE_IDLE) && (sys.state != STATE_JOG)) { sys.jog_continuous = false; }
+    if (sys.suspend) { sys.jog_continuous = false; }
+    // End like a zero rate, if the host hasn't renewed the jog in time. It may have stalled.
+    if (system_deadline_passed(jog_deadline)) { sys.jog_continuous = false; }
+    if (!sys.jog_continuous) { return; }
+
+    plan_line_data_t plan_data;
+    memset(&plan_data,0,sizeof(plan_line_data_t));
+    plan_data.feed_rate = jog_rate;
+    plan_data.spindle_speed = gc_state.spindle_speed;
+    plan_data.condition = (gc_state.modal.spindle | gc_state.modal.coolant | PL_COND_FLAG_NO_FEED_OVERRIDE);
+    #ifdef USE_LINE_NUMBERS
+      plan_data.line_number = JOG_LINE_NUMBER;
+    #endif
+
+    float length;
+    uint8_t idx;
+    while (sys.jog_continuous && (plan_get_block_buffer_count() < jog_horizon)) {
+      length = jog_segment_mm;
+      if (length >= jog_remaining_mm) { // Last segment ends on the travel limit.
+        length = jog_remaining_mm;
+        sys.jog_continuous = false;
+      }
+      jog_remaining_mm -= length;
+      for (idx=0; idx<N_AXIS; idx++) { gc_state.position[idx] += length*jog_unit_vec[idx]; }
+      system_clamp_travel_limits(gc_state.position); // Accumulated rounding must not soft limit alarm.
+      #ifdef ENABLE_GCODE_FIXED_POINT
+        gc_invalidate_fixed(); // Parser position moved outside gc_execute_line().
+      #endif
+      mc_line(gc_state.position, &plan_data);
+      if (sys.abort) { return; }
+    }
+
+    if (sys.state == STATE_IDLE) {
+      if (plan_get_current_block() != NULL) { // Check if there is a block to execute.
+        sys.state = STATE_JOG;
+        st_prep_buffer();
+        st_wake_up();  // NOTE: Manual start. No state machine required.
+      }
+    }
+  }
+#endif
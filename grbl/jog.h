@@ -29,4 +29,12 @@
 // Sets up valid jog motion received from g-code parser, checks for soft-limits, and executes the jog.
 uint8_t jog_execute(plan_line_data_t *pl_data, parser_block_t *gc_block);
 
+#ifdef ENABLE_CONTINUOUS_JOG
+  // Sets up or changes a continuous jog from a '$JC=' direction and rate command line.
+  uint8_t jog_continuous_execute(char *line, uint8_t char_counter);
+
+  // Queues rolling continuous jog segments up to the stopping distance horizon. Called by main loop.
+  void jog_continuous_update();
+#endif
+
 #endif
@@ -139,20 +139,42 @@ uint8_t limits_get_state()
 
 
 
-// Homes the specified cycle axes, sets the machine position, and performs a pull-off motion after
-// completing. Homing is a special motion case, which involves rapid uncontrolled stops to locate
-// the trigger point of the limit switches. The rapid stops are handled by a system level axis lock
-// mask, which prevents the stepper algorithm from executing step pulses. Homing motions typically
-// circumvent the processes for executing motions in normal operation.
-// NOTE: Only the abort realtime command can interrupt this process.
-// TODO: Move limit pin-specific calls to a general function for portability.
-void limits_go_home()
-{
-  if (sys.abort) { return; } // Block if system reset has been issued.
+// Bungard CCD homing phases, run in order by limits_go_home(). The CCD only reports a combined
+// ALL_HOME input, which is set once every axis rests on its switch. While approaching, the limit
+// override is off and the machine itself stops each axis at its switch. Moving away requires the
+// override.
+#define HOMING_PHASE_SEEK_Z    0 // Raise Z over full travel to clear the workspace. Not sensed.
+#define HOMING_PHASE_SEEK_XY   1 // Seek X and Y at seek rate until ALL_HOME.
+#define HOMING_PHASE_BACKOFF   2 // Back all axes off by the locate distance.
+#define HOMING_PHASE_LOCATE    3 // Re-touch all axes together at feed rate until ALL_HOME.
+#define HOMING_PHASE_PULLOFF   4 // Pull off to the machine origin.
+#define HOMING_PHASE_FAST_Z    5 // Trusted position only. Move Z at seek rate to near its switch.
+#define HOMING_PHASE_FAST_XY   6 // Trusted position only. Move X and Y at seek rate to near their switches.
+#define HOMING_PHASE_DONE      7
+
+#define HOMING_ALL_HOME_MASK   0x04 // LIMIT_PIN bit of the CCD ALL_HOME input.
+
+#ifdef BUNGARD_HOMING_DEBUG
+  #define HOMING_DEBUG(s) printPgmString(PSTR(s))
+#else
+  #define HOMING_DEBUG(s)
+#endif
 
-  printPgmString(PSTR("limits_go_home\r\n"));
-  
-  // Initialize plan data struct for homing motion. Spindle and coolant are disabled.
+#ifdef BUNGARD_HOMING_TRUSTED_POSITION
+  static uint8_t limits_home_trusted; // Machine position known from a completed homing cycle.
+
+  // Marks the homed machine position as lost. Called when entering an alarm or sleep state.
+  void limits_invalidate_home() { limits_home_trusted = false; }
+#endif
+
+
+// Runs one homing motion of the axes in cycle_mask. Each axis moves by its 'distance', positive away
+// from the switches, from its current position. If approaching, the motion stops as soon as ALL_HOME
+// is set. Returns true, if ALL_HOME stopped the motion, and false, if the motion completed. Sets
+// the homing alarm and returns false on a failure. Does nothing after an abort.
+static uint8_t limits_homing_motion(uint8_t cycle_mask, float *distance, float rate, uint8_t approach)
+{
+  if (sys.abort) { return(false); } // Reset or door already handled. Don't start new motion.
   plan_line_data_t plan_data;
   plan_line_data_t *pl_data = &plan_data;
   memset(pl_data,0,sizeof(plan_line_data_t));
@@ -161,175 +183,223 @@ void limits_go_home()
     pl_data->line_number = HOMING_CYCLE_LINE_NUMBER;
   #endif
 
-  // Initialize variables used for homing computations.
-  uint8_t n_cycle = (2*N_HOMING_LOCATE_CYCLE+1);
-  uint8_t step_pin[N_AXIS];
   float target[N_AXIS];
+  uint8_t axislock = 0;
   uint8_t idx;
-  
+  system_convert_array_steps_to_mpos(target,sys_position);
   for (idx=0; idx<N_AXIS; idx++) {
-    // Initialize step pin masks
-    step_pin[idx] = get_step_pin_mask(idx);
+    if (bit_istrue(cycle_mask,bit(idx))) {
+      // Switches are at the XY minimum and the Z maximum.
+      sys_position[idx] = 0;
+      target[idx] = (idx == Z_AXIS) ? -distance[idx] : distance[idx];
+      axislock |= get_step_pin_mask(idx);
+    }
   }
-  
-  // Set search mode with approach at seek rate to quickly engage the specified cycle_mask limit switches.
-  bool approach = true;
-  float homing_rate = settings.homing_seek_rate;
-  uint8_t axislock = 0;
-  float max_travel = 0.0f;
 
+  // Only allow limit switch override if we are going away from the switches
+  bel_set_steppers_limit_override_enable(!approach);
+
+  #ifdef BUNGARD_HOMING_DEBUG
+    printPgmString(PSTR("Axislock:"));
+    print_uint8_base2_ndigit(axislock, 8);
+    printPgmString(PSTR("\r\n"));
+  #endif
+  sys.homing_axis_lock = axislock;
+
+  // Perform homing motion. Planner buffer should be empty, as required to initiate the homing cycle.
+  pl_data->feed_rate = rate;
+  plan_buffer_line(target, pl_data); // Bypass mc_line(). Directly plan homing motion.
+  sys.step_control = STEP_CONTROL_EXECUTE_SYS_MOTION; // Set to execute homing motion and clear existing flags.
+  st_prep_buffer(); // Prep and fill segment buffer from newly planned block.
+  st_wake_up(); // Initiate motion
+
+  uint8_t is_home = false;
   do {
-    system_convert_array_steps_to_mpos(target,sys_position);
-    axislock = 0;
-    
-    // Only allow limit switch override if we are going away from the switches
-    bel_set_steppers_limit_override_enable(!approach);
-    
-    // First, bring the Z axis up all the way
-    // Then step X and Y until ALL_HOME is set
-    for (uint8_t i = 0; i<2; i++)
-    {
-      uint8_t cycle_mask = (i == 0) ? bit(Z_AXIS) : bit(X_AXIS) | bit(Y_AXIS);
-
-      for (idx=0; idx<N_AXIS; idx++) {
-        // Set target location for active axes and setup computation for homing rate.
-        if (bit_istrue(cycle_mask,bit(idx))) {
-          sys_position[idx] = 0;
-          // If this is the first cycle, use the whole travel range
-          if (n_cycle == 2*N_HOMING_LOCATE_CYCLE+1)
-            max_travel = (-HOMING_AXIS_SEARCH_SCALAR)*settings.max_travel[idx];
-          // Set target direction based on axis and homing cycle approach state.
-          if (idx != Z_AXIS) {
-            if (approach) { target[idx] = -max_travel; }
-            else { target[idx] = max_travel; }
-          } else {
-            if (approach) { target[idx] = max_travel; }
-            else { target[idx] = -max_travel; }
-          }
-          // Apply axislock to the step port pins active in this cycle.
-          axislock |= step_pin[idx];
-        }
+    if (approach && (LIMIT_PIN & HOMING_ALL_HOME_MASK)) {
+      is_home = true;
+      axislock = 0;
+      sys.homing_axis_lock = 0;
+    }
+    st_prep_buffer(); // Check and prep segment buffer. NOTE: Should take no longer than 200us.
+
+    // Exit routines: No time to run protocol_execute_realtime() in this loop.
+    if (sys_rt_exec_state & (EXEC_SAFETY_DOOR | EXEC_RESET | EXEC_CYCLE_STOP)) {
+      uint8_t rt_exec = sys_rt_exec_state;
+      // Homing failure condition: Reset issued during cycle.
+      if (rt_exec & EXEC_RESET) { system_set_exec_alarm(EXEC_ALARM_HOMING_FAIL_RESET); }
+      // Homing failure condition: Safety door was opened.
+      if (rt_exec & EXEC_SAFETY_DOOR) { system_set_exec_alarm(EXEC_ALARM_HOMING_FAIL_DOOR); }
+      if (sys_rt_exec_alarm) {
+        mc_reset(); // Stop motors, if they are running.
+        protocol_execute_realtime();
+        return(false);
       }
-  
-      printPgmString(PSTR("Axislock:"));
-      print_uint8_base2_ndigit(axislock, 8);
-      printPgmString(PSTR("\r\n"));
-  
-      sys.homing_axis_lock = axislock;
-  
-      // Perform homing cycle. Planner buffer should be empty, as required to initiate the homing cycle.
-      pl_data->feed_rate = homing_rate; // Set current homing rate.
-      plan_buffer_line(target, pl_data); // Bypass mc_line(). Directly plan homing motion.
-  
-      sys.step_control = STEP_CONTROL_EXECUTE_SYS_MOTION; // Set to execute homing motion and clear existing flags.
-      
-      st_prep_buffer(); // Prep and fill segment buffer from newly planned block.
-      st_wake_up(); // Initiate motion
-  
-      do {
-        // Check if all axes are home
-        if (approach && PINB & 0x4) {
-          axislock &= ~get_step_pin_mask(X_AXIS);
-          axislock &= ~get_step_pin_mask(Y_AXIS);
-          axislock &= ~get_step_pin_mask(Z_AXIS);
-        }
-        sys.homing_axis_lock = axislock;
-     
-        st_prep_buffer(); // Check and prep segment buffer. NOTE: Should take no longer than 200us.
-    
-        // Exit routines: No time to run protocol_execute_realtime() in this loop.
-        if (sys_rt_exec_state & (EXEC_SAFETY_DOOR | EXEC_RESET | EXEC_CYCLE_STOP)) {
-          uint8_t rt_exec = sys_rt_exec_state;
-          // Homing failure condition: Reset issued during cycle.
-          if (rt_exec & EXEC_RESET) { system_set_exec_alarm(EXEC_ALARM_HOMING_FAIL_RESET); }
-          // Homing failure condition: Safety door was opened.
-          if (rt_exec & EXEC_SAFETY_DOOR) { system_set_exec_alarm(EXEC_ALARM_HOMING_FAIL_DOOR); }
-          // Homing failure condition: Limit switch still engaged after pull-off motion
-          //if (!approach && (limits_get_state() & cycle_mask)) { system_set_exec_alarm(EXEC_ALARM_HOMING_FAIL_PULLOFF); }
-          // Homing failure condition: Limit switch not found during approach of axes XY.
-          if (i == 1 && approach && (rt_exec & EXEC_CYCLE_STOP)) { system_set_exec_alarm(EXEC_ALARM_HOMING_FAIL_APPROACH); }
-          if (sys_rt_exec_alarm) {
-            mc_reset(); // Stop motors, if they are running.
-            protocol_execute_realtime();
-            return;
-          } else {
-            // Approach or pull-off motion complete. Disable CYCLE_STOP from executing.
-            system_clear_exec_state_flag(EXEC_CYCLE_STOP);
-            break;
-          }
-        }
-      } while (STEP_MASK & axislock);
-      st_reset(); // Immediately force kill steppers and reset step segment buffer.
+      // Motion complete. Disable CYCLE_STOP from executing.
+      system_clear_exec_state_flag(EXEC_CYCLE_STOP);
+      break;
     }
+  } while (STEP_MASK & axislock);
+  st_reset(); // Immediately force kill steppers and reset step segment buffer.
+  return(is_home);
+}
 
-    delay_ms(settings.homing_debounce_delay); // Delay to allow transient dynamics to dissipate.
 
-    // Reverse direction and reset homing rate for locate cycle(s).
-    approach = !approach;
+// Homes all axes of the Bungard CCD, sets the machine position, and performs a pull-off motion
+// after completing. Homing is a special motion case, which involves rapid uncontrolled stops to
+// locate the trigger point of the limit switches. The rapid stops are handled by a system level
+// axis lock mask, which prevents the stepper algorithm from executing step pulses. Homing motions
+// circumvent the processes for executing motions in normal operation.
+// The cycle is a state machine over the HOMING_PHASE_x phases. Z is raised alone before X and Y
+// move, to keep the tool clear of the workpiece. The locate phases then move all axes together
+// with the ALL_HOME input as the only trigger. If BUNGARD_HOMING_TRUSTED_POSITION is enabled and
+// the last homed position is still valid, the seek phases are replaced by direct moves to near the
+// switches and a single locate verifies and refines the switch position.
+// NOTE: Only the abort realtime command can interrupt this process.
+void limits_go_home()
+{
+  if (sys.abort) { return; } // Block if system reset has been issued.
+  HOMING_DEBUG("limits_go_home\r\n");
 
-    // After first cycle, homing enters locating phase. Shorten search to pull-off distance.
-    if (approach) {
-      max_travel = settings.homing_pulloff*HOMING_AXIS_LOCATE_SCALAR;
-      homing_rate = settings.homing_feed_rate;
-    } else {
-      max_travel = settings.homing_pulloff;
-      homing_rate = settings.homing_seek_rate;
+  const uint8_t all_axes = (bit(X_AXIS)|bit(Y_AXIS)|bit(Z_AXIS));
+  float distance[N_AXIS];
+  uint8_t n_locate = N_HOMING_LOCATE_CYCLE;
+  uint8_t phase = HOMING_PHASE_SEEK_Z;
+  uint8_t is_home = false;
+  uint8_t idx;
+  #ifdef BUNGARD_HOMING_TRUSTED_POSITION
+    float position[N_AXIS];
+    uint8_t is_fast = limits_home_trusted;
+    if (is_fast) {
+      system_convert_array_steps_to_mpos(position,sys_position);
+      phase = HOMING_PHASE_FAST_Z;
     }
+    limits_home_trusted = false; // Until this cycle completes.
+  #endif
 
-  
-  } while (n_cycle-- > 0);
-
-  // The active cycle axes should now be homed and machine limits have been located. By
-  // default, Grbl defines machine space as all negative, as do most CNCs. Since limit switches
-  // can be on either side of an axes, check and set axes machine zero appropriately. Also,
-  // set up pull-off maneuver from axes limit switches that have been homed. This provides
-  // some initial clearance off the switches and should also help prevent them from falsely
-  // triggering when hard limits are enabled or when more than one axes shares a limit pin.
-  int32_t set_axis_position;
-  // Set machine positions for homed limit switches. Don't update non-homed axes.
-  for (idx=0; idx<N_AXIS; idx++) {
-    // NOTE: settings.max_travel[] is stored as a negative value.
-    if (1) {
-    //  #ifdef HOMING_FORCE_SET_ORIGIN
-        set_axis_position = 0;
-    /*  #else
-        if ( bit_istrue(settings.homing_dir_mask,bit(idx)) ) {
-          set_axis_position = lround((settings.max_travel[idx]+settings.homing_pulloff)*settings.steps_per_mm[idx]);
-        } else {
-          set_axis_position = lround(-settings.homing_pulloff*settings.steps_per_mm[idx]);
+  while (phase != HOMING_PHASE_DONE) {
+    switch (phase) {
+      case HOMING_PHASE_SEEK_Z:
+        HOMING_DEBUG("Seek Z\r\n");
+        distance[Z_AXIS] = HOMING_AXIS_SEARCH_SCALAR*settings.max_travel[Z_AXIS]; // max_travel is negative.
+        is_home = limits_homing_motion(bit(Z_AXIS), distance, settings.homing_seek_rate, true);
+        phase = HOMING_PHASE_SEEK_XY;
+        break;
+      case HOMING_PHASE_SEEK_XY:
+        HOMING_DEBUG("Seek XY\r\n");
+        if (!is_home) { // Skipped, if X and Y already rest on their switches.
+          distance[X_AXIS] = HOMING_AXIS_SEARCH_SCALAR*settings.max_travel[X_AXIS];
+          distance[Y_AXIS] = HOMING_AXIS_SEARCH_SCALAR*settings.max_travel[Y_AXIS];
+          is_home = limits_homing_motion(bit(X_AXIS)|bit(Y_AXIS), distance, settings.homing_seek_rate, true);
+          // Homing failure condition: Limit switch not found during approach of axes XY.
+          if (!is_home && !sys_rt_exec_alarm && !sys.abort) { system_set_exec_alarm(EXEC_ALARM_HOMING_FAIL_APPROACH); }
+        }
+        phase = HOMING_PHASE_BACKOFF;
+        break;
+      case HOMING_PHASE_BACKOFF:
+        HOMING_DEBUG("Back off\r\n");
+        delay_ms(settings.homing_debounce_delay); // Let the switches settle after being hit.
+        for (idx=0; idx<N_AXIS; idx++) { distance[idx] = BUNGARD_HOMING_LOCATE_DISTANCE; }
+        limits_homing_motion(all_axes, distance, settings.homing_seek_rate, false);
+        // Homing failure condition: Back-off within the switch hysteresis. Locate would end at once.
+        if ((LIMIT_PIN & HOMING_ALL_HOME_MASK) && !sys_rt_exec_alarm && !sys.abort) {
+          system_set_exec_alarm(EXEC_ALARM_HOMING_FAIL_PULLOFF);
         }
-      #endif*/
-      sys_position[idx] = set_axis_position;
+        phase = HOMING_PHASE_LOCATE;
+        break;
+      case HOMING_PHASE_LOCATE:
+        HOMING_DEBUG("Locate\r\n");
+        for (idx=0; idx<N_AXIS; idx++) { distance[idx] = -HOMING_AXIS_LOCATE_SCALAR*BUNGARD_HOMING_LOCATE_DISTANCE; }
+        is_home = limits_homing_motion(all_axes, distance, settings.homing_feed_rate, true);
+        #ifdef BUNGARD_HOMING_TRUSTED_POSITION
+          if (is_fast) {
+            is_fast = false;
+            if (!is_home && !sys_rt_exec_alarm && !sys.abort) {
+              // Switches not where the trusted position placed them. Fall back to a full cycle.
+              HOMING_DEBUG("Untrusted\r\n");
+              phase = HOMING_PHASE_SEEK_Z;
+              break;
+            }
+            n_locate = 1; // Verified. No further locate cycles.
+          }
+        #endif
+        if (!is_home && !sys_rt_exec_alarm && !sys.abort) { system_set_exec_alarm(EXEC_ALARM_HOMING_FAIL_APPROACH); }
+        if (n_locate > 1) { n_locate--; phase = HOMING_PHASE_BACKOFF; }
+        else { phase = HOMING_PHASE_PULLOFF; }
+        break;
+      case HOMING_PHASE_PULLOFF:
+        HOMING_DEBUG("Pull-off\r\n");
+        delay_ms(settings.homing_debounce_delay); // Let the switches settle after being hit.
+        for (idx=0; idx<N_AXIS; idx++) { distance[idx] = settings.homing_pulloff; }
+        limits_homing_motion(all_axes, distance, settings.homing_seek_rate, false);
+        phase = HOMING_PHASE_DONE;
+        break;
+      #ifdef BUNGARD_HOMING_TRUSTED_POSITION
+        case HOMING_PHASE_FAST_Z: case HOMING_PHASE_FAST_XY:
+          // Move at seek rate to the locate distance short of the switches, which are the pull-off distance beyond
+          // the origin. Z first, to keep the tool clear of the workpiece.
+          HOMING_DEBUG("Fast home\r\n");
+          if (phase == HOMING_PHASE_FAST_Z) {
+            distance[Z_AXIS] = position[Z_AXIS]-settings.homing_pulloff+BUNGARD_HOMING_LOCATE_DISTANCE;
+            is_home = limits_homing_motion(bit(Z_AXIS), distance, settings.homing_seek_rate, true);
+            phase = HOMING_PHASE_FAST_XY;
+          } else {
+            distance[X_AXIS] = BUNGARD_HOMING_LOCATE_DISTANCE-settings.homing_pulloff-position[X_AXIS];
+            distance[Y_AXIS] = BUNGARD_HOMING_LOCATE_DISTANCE-settings.homing_pulloff-position[Y_AXIS];
+            if (!is_home) { limits_homing_motion(bit(X_AXIS)|bit(Y_AXIS), distance, settings.homing_seek_rate, true); }
+            phase = HOMING_PHASE_LOCATE;
+          }
+          break;
+      #endif
+    }
+    // NOTE: An alarm raised inside limits_homing_motion() is already executed and cleared by the
+    // realtime protocol there, so only sys.abort is left to tell.
+    if (sys_rt_exec_alarm || sys.abort) {
+      if (!sys.abort) {
+        mc_reset(); // Stop motors, if they are running.
+        protocol_execute_realtime();
+      }
+      return;
     }
   }
-  
+
+  // All axes are now homed and pulled off the switches. Set the machine origin here.
+  memset(sys_position,0,sizeof(sys_position));
+  #ifdef BUNGARD_HOMING_TRUSTED_POSITION
+    limits_home_trusted = true;
+  #endif
+
   // Override the Bungard CCD limit switches to allow full range of motion
   bel_set_steppers_limit_override_enable(true);
-  
+
   sys.step_control = STEP_CONTROL_NORMAL_OP; // Return step control to normal operation.
 }
 
 
-// Performs a soft limit check. Called from mc_line() only. Assumes the machine has been homed,
-// the workspace volume is in all negative space, and the system is in normal operation.
-// NOTE: Used by jogging to limit travel within soft-limit volume.
-void limits_soft_check(float *target)
+// Handles a soft limit violation. Called by motion control, when the planner rejects a line or an
+// arc bounding box is out of bounds. Assumes the machine has been homed, the workspace volume is in
+// all negative space, and the system is in normal operation.
+void limits_soft_limit_alarm()
 {
-  if (system_check_travel_limits(target)) {
-    sys.soft_limit = true;
-    // Force feed hold if cycle is active. All buffered blocks are guaranteed to be within
-    // workspace volume so just come to a controlled stop so position is not lost. When complete
-    // enter alarm mode.
-    if (sys.state == STATE_CYCLE) {
-      system_set_exec_state_flag(EXEC_FEED_HOLD);
-      do {
-        protocol_execute_realtime();
-        if (sys.abort) { return; }
-      } while ( sys.state != STATE_IDLE );
-    }
-    mc_reset(); // Issue system reset and ensure spindle and coolant are shutdown.
-    system_set_exec_alarm(EXEC_ALARM_SOFT_LIMIT); // Indicate soft limit critical event
-    protocol_execute_realtime(); // Execute to enter critical event loop and system abort
-    return;
+  sys.soft_limit = true;
+  // Force feed hold if cycle is active. All buffered blocks are guaranteed to be within
+  // workspace volume so just come to a controlled stop so position is not lost. When complete
+  // enter alarm mode.
+  if (sys.state == STATE_CYCLE) {
+    system_set_exec_state_flag(EXEC_FEED_HOLD);
+    do {
+      protocol_execute_realtime();
+      if (sys.abort) { return; }
+    } while ( sys.state != STATE_IDLE );
   }
+  mc_reset(); // Issue system reset and ensure spindle and coolant are shutdown.
+  system_set_exec_alarm(EXEC_ALARM_SOFT_LIMIT); // Indicate soft limit critical event
+  protocol_execute_realtime(); // Execute to enter critical event loop and system abort
+}
+
+
+// Performs a soft limit check of a target, which is not passed through the planner, i.e. in check
+// mode or the corners of an arc bounding box.
+void limits_soft_check(float *target)
+{
+  if (system_check_travel_limits(target)) { limits_soft_limit_alarm(); }
 }
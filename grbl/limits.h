@@ -35,6 +35,14 @@ uint8_t limits_get_state();
 // Perform the homing cycle
 void limits_go_home();
 
+#ifdef BUNGARD_HOMING_TRUSTED_POSITION
+  // Marks the homed machine position as lost, forcing a full homing cycle next time.
+  void limits_invalidate_home();
+#endif
+
+// Handle a soft limit violation
+void limits_soft_limit_alarm();
+
 // Check for soft limit violations
 void limits_soft_check(float *target);
 
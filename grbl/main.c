@@ -24,7 +24,12 @@
 
 // Declare system global variable structure
 system_t sys;
-int32_t sys_position[N_AXIS];      // Real-time machine (aka home) position vector in steps.
+#ifdef ENABLE_POSITION_RESTORE
+  // Not cleared by the C startup code, so the position survives a reset. See system_restore_position().
+  int32_t sys_position[N_AXIS] __attribute__ ((section (".noinit")));
+#else
+  int32_t sys_position[N_AXIS];      // Real-time machine (aka home) position vector in steps.
+#endif
 int32_t sys_probe_position[N_AXIS]; // Last probe position in machine coordinates and steps.
 volatile uint8_t sys_probe_state;   // Probing state value.  Used to coordinate the probing cycle with stepper ISR.
 volatile uint8_t sys_rt_exec_state;   // Global realtime executor bitflag variable for state management. See EXEC bitmasks.
@@ -39,13 +44,24 @@ volatile uint8_t sys_rt_exec_accessory_override; // Global realtime executor bit
 int main(void)
 {
   // Initialize system upon power-up.
+  #ifdef ENABLE_BUFFER_RAM_BUDGET
+    system_init_buffers(); // Must be first, before the stack has grown. Before serial_init().
+  #endif
+  #ifdef REPORT_MEMORY_USAGE
+    system_paint_stack(); // Must be before the stack has grown.
+  #endif
   serial_init();   // Setup serial baud rate and interrupts
   settings_init(); // Load Grbl settings from EEPROM
   bel_init();      // Initialize Bungard hardware
   stepper_init();  // Configure stepper pins and interrupt timers
   system_init();   // Configure pinout pins and pin-change interrupt
 
-  memset(sys_position,0,sizeof(sys_position)); // Clear machine position.
+  #ifdef ENABLE_POSITION_RESTORE
+    uint8_t is_restored = system_restore_position();
+    if (!is_restored) { memset(sys_position,0,sizeof(sys_position)); } // Clear machine position.
+  #else
+    memset(sys_position,0,sizeof(sys_position)); // Clear machine position.
+  #endif
   sei(); // Enable interrupts
 
   // Initialize system state.
@@ -66,6 +82,9 @@ int main(void)
   #ifdef HOMING_INIT_LOCK
     if (bit_istrue(settings.flags,BITFLAG_HOMING_ENABLE)) { sys.state = STATE_ALARM; }
   #endif
+  #ifdef ENABLE_POSITION_RESTORE
+    if (is_restored) { sys.state = STATE_IDLE; } // Position is known. No need to home.
+  #endif
 
   // Grbl initialization loop upon power-up or a system abort. For the latter, all processes
   // will return to this loop to be cleanly re-initialized.
@@ -100,6 +119,12 @@ int main(void)
 
     // Print welcome message. Indicates an initialization has occured at power-up or with a reset.
     report_init_message();
+    #ifdef ENABLE_POSITION_RESTORE
+      if (is_restored) {
+        report_feedback_message(MESSAGE_POSITION_RESTORED);
+        is_restored = false;
+      }
+    #endif
 
     // Start Grbl main loop. Processes program inputs and executes them.
     protocol_main_loop();
@@ -29,31 +29,19 @@
 // segments, must pass through this routine before being passed to the planner. The seperation of
 // mc_line and plan_buffer_line is done primarily to place non-planner-type functions from being
 // in the planner and to let backlash compensation or canned cycle integration simple and direct.
-void mc_line(float *target, plan_line_data_t *pl_data)
+// NOTE: Plans the line as given. mc_line() applies the height map on top of this, where enabled.
+static void mc_plan_line(float *target, plan_line_data_t *pl_data)
 {
-  // If enabled, check for soft limit violations. Placed here all line motions are picked up
-  // from everywhere in Grbl.
-  if (bit_istrue(settings.flags,BITFLAG_SOFT_LIMIT_ENABLE)) {
-    // NOTE: Block jog state. Jogging is a special case and soft limits are handled independently.
-    if (sys.state != STATE_JOG) { limits_soft_check(target); }
-  }
-
   // If in check gcode mode, prevent motion by blocking planner. Soft limits still work.
-  if (sys.state == STATE_CHECK_MODE) { return; }
+  // NOTE: Otherwise, soft limits are checked by the planner in the step domain. See plan_buffer_line().
+  if (sys.state == STATE_CHECK_MODE) {
+    if (bit_istrue(settings.flags,BITFLAG_SOFT_LIMIT_ENABLE)) { limits_soft_check(target); }
+    return;
+  }
 
-  // NOTE: Backlash compensation may be installed here. It will need direction info to track when
-  // to insert a backlash line motion(s) before the intended line motion and will require its own
-  // plan_check_full_buffer() and check for system abort loop. Also for position reporting
-  // backlash steps will need to be also tracked, which will need to be kept at a system level.
-  // There are likely some other things that will need to be tracked as well. However, we feel
-  // that backlash compensation should NOT be handled by Grbl itself, because there are a myriad
-  // of ways to implement it and can be effective or ineffective for different CNC machines. This
-  // would be better handled by the interface as a post-processor task, where the original g-code
-  // is translated and inserts backlash motions that best suits the machine.
-  // NOTE: Perhaps as a middle-ground, all that needs to be sent is a flag or special command that
-  // indicates to Grbl what is a backlash compensation motion, so that Grbl executes the move but
-  // doesn't update the machine position values. Since the position values used by the g-code
-  // parser and planner are separate from the system machine positions, this is doable.
+  // NOTE: Backlash compensation is not a separate motion. The planner tracks the axes directions in
+  // the step domain and merges the backlash steps into the block that reverses an axis. Neither the
+  // planner nor the machine position count them, so the g-code parser position is unaffected.
 
   // If the buffer is full: good! That means we are well ahead of the robot.
   // Remain in this loop until there is room in the buffer.
@@ -65,7 +53,10 @@ void mc_line(float *target, plan_line_data_t *pl_data)
   } while (1);
 
   // Plan and queue motion into planner buffer
-  if (plan_buffer_line(target, pl_data) == PLAN_EMPTY_BLOCK) {
+  uint8_t plan_status = plan_buffer_line(target, pl_data);
+  if (plan_status == PLAN_TRAVEL_EXCEEDED) {
+    limits_soft_limit_alarm();
+  } else if (plan_status == PLAN_EMPTY_BLOCK) {
     if (bit_istrue(settings.flags,BITFLAG_LASER_MODE)) {
       // Correctly set spindle state, if there is a coincident position passed. Forces a buffer
       // sync while in M3 laser mode only.
@@ -77,6 +68,172 @@ void mc_line(float *target, plan_line_data_t *pl_data)
 }
 
 
+#ifdef ENABLE_HEIGHT_MAP
+  // Plans a line with its Z corrected by the height map. Bilinear interpolation is only linear along
+  // a line within a grid cell, so the line is split where it crosses grid lines and each piece is
+  // corrected at its end point. The start is the planner end position, which has its Z corrected for
+  // the start XY. The correction is removed from it to interpolate the programmed Z.
+  static void mc_height_map_line(float *target, plan_line_data_t *pl_data)
+  {
+    float position[N_AXIS];
+    float segment[N_AXIS];
+    float delta[2];
+    int16_t grid_line[2];
+    int8_t grid_dir[2];
+    uint8_t idx;
+
+    plan_get_planner_mpos(position);
+    position[Z_AXIS] -= probe_height_map_get_z(position[X_AXIS], position[Y_AXIS]);
+
+    // Find the first grid line crossed on each axis in the direction of travel. Grid lines outside
+    // the map don't change the correction and are skipped.
+    for (idx=0; idx<2; idx++) {
+      delta[idx] = target[idx]-position[idx];
+      grid_dir[idx] = 0;
+      if (fabs(delta[idx]) > HEIGHT_MAP_EPSILON) {
+        float g = (position[idx]-height_map.origin[idx])/height_map.spacing[idx];
+        if (delta[idx] > 0.0) {
+          grid_dir[idx] = 1;
+          grid_line[idx] = floor(g)+1;
+          if (grid_line[idx] < 0) { grid_line[idx] = 0; }
+        } else {
+          grid_dir[idx] = -1;
+          grid_line[idx] = ceil(g)-1;
+          if (grid_line[idx] > height_map.n[idx]-1) { grid_line[idx] = height_map.n[idx]-1; }
+        }
+      }
+    }
+
+    // Inverse time feed rates apply to the whole line. Scale them by each piece's fraction of it.
+    float feed_rate = pl_data->feed_rate;
+    float t_prev = 0.0;
+    float t, t_axis[2];
+    do {
+      t = 1.0;
+      for (idx=0; idx<2; idx++) {
+        t_axis[idx] = 1.0;
+        if (grid_dir[idx] && (grid_line[idx] >= 0) && (grid_line[idx] < height_map.n[idx])) {
+          t_axis[idx] = (height_map.origin[idx]+grid_line[idx]*height_map.spacing[idx]-position[idx])/delta[idx];
+          if (t_axis[idx] < t) { t = t_axis[idx]; }
+        }
+      }
+      // Advance past every grid line crossed here. Both axes at once, if passing through a grid point.
+      for (idx=0; idx<2; idx++) {
+        if (t_axis[idx] <= t+HEIGHT_MAP_EPSILON) { grid_line[idx] += grid_dir[idx]; }
+      }
+      if (t > 1.0-HEIGHT_MAP_EPSILON) { t = 1.0; }
+      if (t > t_prev) {
+        for (idx=0; idx<N_AXIS; idx++) { segment[idx] = position[idx]+t*(target[idx]-position[idx]); }
+        if (t == 1.0) { segment[X_AXIS] = target[X_AXIS]; segment[Y_AXIS] = target[Y_AXIS]; }
+        segment[Z_AXIS] += probe_height_map_get_z(segment[X_AXIS], segment[Y_AXIS]);
+        if (pl_data->condition & PL_COND_FLAG_INVERSE_TIME) { pl_data->feed_rate = feed_rate/(t-t_prev); }
+        mc_plan_line(segment, pl_data);
+        if (sys.abort) { break; }
+        t_prev = t;
+      }
+    } while (t < 1.0);
+    pl_data->feed_rate = feed_rate;
+  }
+#endif
+
+
+// Arc chord generator state. Chords are queued on demand as planner blocks free up, so the main
+// loop keeps reading and parsing serial input while a large arc executes.
+typedef struct {
+  uint16_t segments;            // Number of chords of the pending arc. Zero when none pending.
+  uint16_t index;               // Index of the next chord to generate.
+  uint8_t count;                // Chords generated since the last exact arc correction.
+  uint8_t axis_0;               // Circle plane axes and helical axis.
+  uint8_t axis_1;
+  uint8_t axis_linear;
+  float center[2];              // Circle center in the plane.
+  float r[2];                   // Current radius vector from center.
+  float r_start[2];             // Initial radius vector from center, i.e. -offset.
+  float theta_per_segment;
+  float linear_per_segment;
+  float cos_T;
+  float sin_T;
+  float position[N_AXIS];       // End point of the last generated chord.
+  float target[N_AXIS];         // Arc end point.
+  plan_line_data_t pl_data;     // Copy of the motion data for all chords.
+} mc_arc_t;
+static mc_arc_t arc;
+
+
+// Plans a line, Z corrected by the height map, if a map has been probed.
+static void mc_queue_line(float *target, plan_line_data_t *pl_data)
+{
+  #ifdef ENABLE_HEIGHT_MAP
+    if (height_map.n[X_AXIS]) {
+      mc_height_map_line(target, pl_data);
+      return;
+    }
+  #endif
+  mc_plan_line(target, pl_data);
+}
+
+
+// Generates the chords of the pending arc. If waiting, blocks until all of them are queued, just like
+// successive mc_line() calls. Otherwise, only fills the free planner blocks and returns.
+static void mc_arc_generate(uint8_t is_waiting)
+{
+  while (arc.segments) {
+    if (sys.abort) { arc.segments = 0; return; }
+    if (!is_waiting && plan_check_full_buffer()) { return; }
+
+    if (arc.index == arc.segments) {
+      // Ensure last segment arrives at target location.
+      arc.segments = 0;
+      mc_queue_line(arc.target, &arc.pl_data);
+      return;
+    }
+
+    if (arc.count < N_ARC_CORRECTION) {
+      // Apply vector rotation matrix. ~40 usec
+      float r_axisi = arc.r[0]*arc.sin_T + arc.r[1]*arc.cos_T;
+      arc.r[0] = arc.r[0]*arc.cos_T - arc.r[1]*arc.sin_T;
+      arc.r[1] = r_axisi;
+      arc.count++;
+    } else {
+      // Arc correction to radius vector. Computed only every N_ARC_CORRECTION increments. ~375 usec
+      // Compute exact location by applying transformation matrix from initial radius vector(=-offset).
+      float cos_Ti = cos(arc.index*arc.theta_per_segment);
+      float sin_Ti = sin(arc.index*arc.theta_per_segment);
+      arc.r[0] = arc.r_start[0]*cos_Ti - arc.r_start[1]*sin_Ti;
+      arc.r[1] = arc.r_start[0]*sin_Ti + arc.r_start[1]*cos_Ti;
+      arc.count = 0;
+    }
+    arc.index++;
+
+    // Update arc_target location
+    arc.position[arc.axis_0] = arc.center[0] + arc.r[0];
+    arc.position[arc.axis_1] = arc.center[1] + arc.r[1];
+    arc.position[arc.axis_linear] += arc.linear_per_segment;
+
+    mc_queue_line(arc.position, &arc.pl_data);
+  }
+}
+
+
+// Queues the chords of a pending arc into the free planner blocks without waiting. Called by the
+// main loop, while it waits for serial input.
+void mc_arc_continue() { mc_arc_generate(false); }
+
+
+// Queues all chords of a pending arc, waiting for planner blocks to free up as needed. Called before
+// anything else is added to the planner or the planner buffer is synchronized.
+void mc_arc_finish() { mc_arc_generate(true); }
+
+
+// Execute linear motion in absolute millimeter coordinates. Entry point for all g-code, arc and jog
+// motions. Applies the height map Z correction, if a map has been probed.
+void mc_line(float *target, plan_line_data_t *pl_data)
+{
+  mc_arc_finish(); // Motions are queued in order. Any pending arc chords go first.
+  mc_queue_line(target, pl_data);
+}
+
+
 // Execute an arc in offset mode format. position == current xyz, target == target xyz,
 // offset == offset from current xyz, axis_X defines circle plane in tool space, axis_linear is
 // the direction of helical travel, radius == circle radius, isclockwise boolean. Used
@@ -84,42 +241,95 @@ void mc_line(float *target, plan_line_data_t *pl_data)
 // The arc is approximated by generating a huge number of tiny, linear segments. The chordal tolerance
 // of each segment is configured in settings.arc_tolerance, which is defined to be the maximum normal
 // distance from segment to the circle when the end points both lie on the circle.
+// NOTE: Only sets up the arc and queues the chords that fit into the planner. The rest are generated
+// by mc_arc_continue() from the main loop, or mc_arc_finish() before the next planner motion.
 void mc_arc(float *target, plan_line_data_t *pl_data, float *position, float *offset, float radius,
   uint8_t axis_0, uint8_t axis_1, uint8_t axis_linear, uint8_t is_clockwise_arc)
 {
-  float center_axis0 = position[axis_0] + offset[axis_0];
-  float center_axis1 = position[axis_1] + offset[axis_1];
-  float r_axis0 = -offset[axis_0];  // Radius vector from center to current location
-  float r_axis1 = -offset[axis_1];
-  float rt_axis0 = target[axis_0] - center_axis0;
-  float rt_axis1 = target[axis_1] - center_axis1;
+  mc_arc_finish(); // Complete any prior arc.
+  if (sys.abort) { return; }
+
+  memcpy(arc.position, position, sizeof(arc.position));
+  memcpy(arc.target, target, sizeof(arc.target));
+  memcpy(&arc.pl_data, pl_data, sizeof(plan_line_data_t));
+  arc.axis_0 = axis_0;
+  arc.axis_1 = axis_1;
+  arc.axis_linear = axis_linear;
+  arc.center[0] = position[axis_0] + offset[axis_0];
+  arc.center[1] = position[axis_1] + offset[axis_1];
+  arc.r_start[0] = -offset[axis_0];  // Radius vector from center to current location
+  arc.r_start[1] = -offset[axis_1];
+  arc.r[0] = arc.r_start[0];
+  arc.r[1] = arc.r_start[1];
+  float rt_axis0 = target[axis_0] - arc.center[0];
+  float rt_axis1 = target[axis_1] - arc.center[1];
 
   // CCW angle between position and target from circle center. Only one atan2() trig computation required.
-  float angular_travel = atan2(r_axis0*rt_axis1-r_axis1*rt_axis0, r_axis0*rt_axis0+r_axis1*rt_axis1);
+  float angular_travel = atan2(arc.r[0]*rt_axis1-arc.r[1]*rt_axis0, arc.r[0]*rt_axis0+arc.r[1]*rt_axis1);
   if (is_clockwise_arc) { // Correct atan2 output per direction
     if (angular_travel >= -ARC_ANGULAR_TRAVEL_EPSILON) { angular_travel -= 2*M_PI; }
   } else {
     if (angular_travel <= ARC_ANGULAR_TRAVEL_EPSILON) { angular_travel += 2*M_PI; }
   }
 
+  // If enabled, check the arc once against the soft limits by its bounding box, so a violating arc is
+  // rejected before any of it is queued. Segments only see the integer check in the planner.
+  if (bit_istrue(settings.flags,BITFLAG_SOFT_LIMIT_ENABLE)) {
+    float box_min[N_AXIS], box_max[N_AXIS];
+    uint8_t idx;
+    for (idx=0; idx<N_AXIS; idx++) {
+      box_min[idx] = min(arc.position[idx],target[idx]);
+      box_max[idx] = max(arc.position[idx],target[idx]);
+    }
+    // Extend the box by the quadrant points of the circle, which the arc sweeps through.
+    float angle_start = atan2(arc.r[1], arc.r[0]);
+    float sweep;
+    for (idx=0; idx<4; idx++) {
+      sweep = idx*(0.5*M_PI) - angle_start; // Angle from start to quadrant point in arc direction.
+      if (is_clockwise_arc) { sweep = -sweep; }
+      if (sweep < 0.0) { sweep += 2*M_PI; }
+      if (sweep >= 2*M_PI) { sweep -= 2*M_PI; }
+      if (sweep < fabs(angular_travel)) {
+        switch (idx) {
+          case 0: box_max[axis_0] = arc.center[0] + radius; break;
+          case 1: box_max[axis_1] = arc.center[1] + radius; break;
+          case 2: box_min[axis_0] = arc.center[0] - radius; break;
+          default: box_min[axis_1] = arc.center[1] - radius;
+        }
+      }
+    }
+    limits_soft_check(box_min);
+    if (sys.abort) { return; }
+    limits_soft_check(box_max);
+    if (sys.abort) { return; }
+  }
+
   // NOTE: Segment end points are on the arc, which can lead to the arc diameter being smaller by up to
   // (2x) settings.arc_tolerance. For 99% of users, this is just fine. If a different arc segment fit
   // is desired, i.e. least-squares, midpoint on arc, just change the mm_per_arc_segment calculation.
   // For the intended uses of Grbl, this value shouldn't exceed 2000 for the strictest of cases.
-  uint16_t segments = floor(fabs(0.5*angular_travel*radius)/
-                          sqrt(settings.arc_tolerance*(2*radius - settings.arc_tolerance)) );
+  float arc_mm = fabs(angular_travel*radius);
+  float chord_mm = 2*sqrt(settings.arc_tolerance*(2*radius - settings.arc_tolerance));
+  // Optionally, chords must last long enough at the programmed feed rate for the planner to keep up.
+  // On small radii at high feed rates, they are then lengthened beyond the arc tolerance.
+  if ((ARC_MIN_CHORD_TIME > 0.0) && !(pl_data->condition & PL_COND_FLAG_INVERSE_TIME)) {
+    chord_mm = max(chord_mm, pl_data->feed_rate*(ARC_MIN_CHORD_TIME/60000.0));
+  }
+  arc.segments = floor(arc_mm/chord_mm);
+  arc.index = 1;
+  arc.count = 0;
 
-  if (segments) {
+  if (arc.segments) {
     // Multiply inverse feed_rate to compensate for the fact that this movement is approximated
     // by a number of discrete segments. The inverse feed_rate should be correct for the sum of
     // all segments.
-    if (pl_data->condition & PL_COND_FLAG_INVERSE_TIME) { 
-      pl_data->feed_rate *= segments; 
-      bit_false(pl_data->condition,PL_COND_FLAG_INVERSE_TIME); // Force as feed absolute mode over arc segments.
+    if (arc.pl_data.condition & PL_COND_FLAG_INVERSE_TIME) {
+      arc.pl_data.feed_rate *= arc.segments;
+      bit_false(arc.pl_data.condition,PL_COND_FLAG_INVERSE_TIME); // Force as feed absolute mode over arc segments.
     }
-    
-    float theta_per_segment = angular_travel/segments;
-    float linear_per_segment = (target[axis_linear] - position[axis_linear])/segments;
+
+    arc.theta_per_segment = angular_travel/arc.segments;
+    arc.linear_per_segment = (target[axis_linear] - position[axis_linear])/arc.segments;
 
     /* Vector rotation by transformation matrix: r is the original vector, r_T is the rotated vector,
        and phi is the angle of rotation. Solution approach by Jens Geisler.
@@ -147,56 +357,39 @@ void mc_arc(float *target, plan_line_data_t *pl_data, float *position, float *of
        This is important when there are successive arc motions.
     */
     // Computes: cos_T = 1 - theta_per_segment^2/2, sin_T = theta_per_segment - theta_per_segment^3/6) in ~52usec
-    float cos_T = 2.0 - theta_per_segment*theta_per_segment;
-    float sin_T = theta_per_segment*0.16666667*(cos_T + 4.0);
-    cos_T *= 0.5;
-
-    float sin_Ti;
-    float cos_Ti;
-    float r_axisi;
-    uint16_t i;
-    uint8_t count = 0;
-
-    for (i = 1; i<segments; i++) { // Increment (segments-1).
-
-      if (count < N_ARC_CORRECTION) {
-        // Apply vector rotation matrix. ~40 usec
-        r_axisi = r_axis0*sin_T + r_axis1*cos_T;
-        r_axis0 = r_axis0*cos_T - r_axis1*sin_T;
-        r_axis1 = r_axisi;
-        count++;
-      } else {
-        // Arc correction to radius vector. Computed only every N_ARC_CORRECTION increments. ~375 usec
-        // Compute exact location by applying transformation matrix from initial radius vector(=-offset).
-        cos_Ti = cos(i*theta_per_segment);
-        sin_Ti = sin(i*theta_per_segment);
-        r_axis0 = -offset[axis_0]*cos_Ti + offset[axis_1]*sin_Ti;
-        r_axis1 = -offset[axis_0]*sin_Ti - offset[axis_1]*cos_Ti;
-        count = 0;
-      }
-
-      // Update arc_target location
-      position[axis_0] = center_axis0 + r_axis0;
-      position[axis_1] = center_axis1 + r_axis1;
-      position[axis_linear] += linear_per_segment;
-
-      mc_line(position, pl_data);
-
-      // Bail mid-circle on system abort. Runtime command check already performed by mc_line.
-      if (sys.abort) { return; }
-    }
+    arc.cos_T = 2.0 - arc.theta_per_segment*arc.theta_per_segment;
+    arc.sin_T = arc.theta_per_segment*0.16666667*(arc.cos_T + 4.0);
+    arc.cos_T *= 0.5;
+  } else {
+    arc.segments = 1; // Single chord straight to the target.
   }
-  // Ensure last segment arrives at target location.
-  mc_line(target, pl_data);
+
+  mc_arc_generate(false); // Queue what fits. The main loop generates the rest.
 }
 
 
 // Execute dwell in seconds.
-void mc_dwell(float seconds)
+void mc_dwell(float seconds, plan_line_data_t *pl_data)
 {
   if (sys.state == STATE_CHECK_MODE) { return; }
-  protocol_buffer_synchronize();
-  delay_sec(seconds, DELAY_MODE_DWELL);
+  #ifdef ENABLE_PROGRAM_MODE
+    // A zero-length dwell only syncs the buffer for the host, which isn't needed within a program.
+    if (sys.program_mode && (seconds == 0.0)) { return; }
+  #endif
+  if (seconds == 0.0) {
+    protocol_buffer_synchronize(); // 'G4 P0' remains a buffer sync for hosts that rely on it.
+    return;
+  }
+
+  // Queue the dwell as a planner block, so the parser keeps filling the buffer during the dwell.
+  mc_arc_finish(); // Any pending arc chords go first.
+  do {
+    protocol_execute_realtime(); // Check for any run-time commands
+    if (sys.abort) { return; } // Bail, if system abort.
+    if ( plan_check_full_buffer() ) { protocol_auto_cycle_start(); } // Auto-cycle start when buffer is full.
+    else { break; }
+  } while (1);
+  plan_buffer_dwell(seconds, pl_data);
 }
 
 
@@ -232,15 +425,102 @@ void mc_homing_cycle(uint8_t cycle_mask)
   // Sync gcode parser and planner positions to homed position.
   gc_sync_position();
   plan_sync_position();
+  #ifdef ENABLE_POSITION_RESTORE
+    system_validate_position(); // Homed and at rest.
+  #endif
 
   // If hard limits feature enabled, re-enable hard limits pin change register after homing cycle.
   limits_init();
 }
 
 
-// Perform tool length probe cycle. Requires probe switch.
+// Runs one probing motion to the target and waits until the probe triggers or the motion completes.
+// Returns true, if the probe triggered. Afterwards, the remainder of the decelerated probe motion is
+// removed from the buffers. Shared by the seek and latch passes of a probe cycle.
+static uint8_t mc_probe_pass(float *target, plan_line_data_t *pl_data)
+{
+  // Setup and queue probing motion. Auto cycle-start should not start the cycle.
+  // NOTE: Not height map corrected. Probes always measure the true surface.
+  mc_plan_line(target, pl_data);
+
+  // Activate the probing state monitor in the stepper module.
+  sys_probe_state = PROBE_ACTIVE;
+
+  // Perform probing cycle. Wait here until probe is triggered or motion completes.
+  system_set_exec_state_flag(EXEC_CYCLE_START);
+  do {
+    protocol_execute_realtime();
+    if (sys.abort) { return(false); } // Check for system abort
+  } while (sys.state != STATE_IDLE);
+
+  uint8_t is_triggered = (sys_probe_state != PROBE_ACTIVE);
+  sys_probe_state = PROBE_OFF; // Ensure probe state monitor is disabled.
+
+  // Reset the stepper and planner buffers to remove the remainder of the probe motion.
+  st_reset(); // Reset step segment buffer.
+  plan_reset(); // Reset planner buffer. Zero planner positions. Ensure probing motion is cleared.
+  plan_sync_position(); // Sync planner position to current machine position.
+  return(is_triggered);
+}
+
+
+#ifdef ENABLE_PROBE_LATCH
+  // Latch pass results.
+  #define PROBE_LATCH_MISSED 0 // No touch within the latch travel. Seek touch is left in sys_probe_position.
+  #define PROBE_LATCH_FOUND 1
+  #define PROBE_LATCH_STUCK 2  // Probe still triggered after backing off.
+
+  // Backs off from the seek touch and re-touches slowly along the same direction, so the recorded
+  // position isn't skewed by the seek rate deceleration and switch response. Runs directly after the
+  // seek pass without a buffer sync or report in between. Returns a PROBE_LATCH result.
+  static uint8_t mc_probe_latch(float *start, float *target, plan_line_data_t *pl_data)
+  {
+    float touch[N_AXIS], unit_vec[N_AXIS];
+    float distance = 0.0;
+    uint8_t idx;
+    system_convert_array_steps_to_mpos(touch, sys_probe_position);
+    for (idx=0; idx<N_AXIS; idx++) {
+      unit_vec[idx] = target[idx]-start[idx];
+      distance += unit_vec[idx]*unit_vec[idx];
+    }
+    distance = sqrt(distance);
+    if (distance == 0.0) { return(PROBE_LATCH_FOUND); }
+
+    // Back off at rapid rate. The seek pass stopped past the touch point by its deceleration.
+    float latch_target[N_AXIS];
+    for (idx=0; idx<N_AXIS; idx++) {
+      unit_vec[idx] /= distance;
+      latch_target[idx] = touch[idx]-PROBE_LATCH_RETRACT*unit_vec[idx];
+    }
+    uint8_t condition = pl_data->condition;
+    float feed_rate = pl_data->feed_rate;
+    pl_data->condition = PL_COND_FLAG_RAPID_MOTION | (condition & PL_COND_COOLANT_MASK); // Keep queued coolant.
+    mc_plan_line(latch_target, pl_data);
+    protocol_buffer_synchronize();
+    if (sys.abort) { return(PROBE_LATCH_MISSED); }
+
+    // Re-touch slowly. Allows the retract distance past the seek touch, but never past the target.
+    if (probe_get_state()) { return(PROBE_LATCH_STUCK); }
+    float overtravel = 0.0;
+    for (idx=0; idx<N_AXIS; idx++) { overtravel += (target[idx]-touch[idx])*unit_vec[idx]; }
+    overtravel = min(max(overtravel, 0.0), PROBE_LATCH_RETRACT);
+    for (idx=0; idx<N_AXIS; idx++) { latch_target[idx] = touch[idx]+overtravel*unit_vec[idx]; }
+    pl_data->condition = condition & ~(PL_COND_FLAG_RAPID_MOTION|PL_COND_FLAG_INVERSE_TIME);
+    pl_data->feed_rate = PROBE_LATCH_FEED_RATE;
+    uint8_t is_triggered = mc_probe_pass(latch_target, pl_data);
+    pl_data->condition = condition;
+    pl_data->feed_rate = feed_rate;
+    if (is_triggered) { return(PROBE_LATCH_FOUND); }
+    return(PROBE_LATCH_MISSED);
+  }
+#endif
+
+
+// Perform tool length probe cycle. Requires probe switch. Reports the probe position, if enabled
+// and requested. The height map probing runs it without the report for every grid point.
 // NOTE: Upon probe failure, the program will be stopped and placed into ALARM state.
-uint8_t mc_probe_cycle(float *target, plan_line_data_t *pl_data, uint8_t parser_flags)
+static uint8_t mc_probe_execute(float *target, plan_line_data_t *pl_data, uint8_t parser_flags,
+  uint8_t is_reported)
 {
   // TODO: Need to update this cycle so it obeys a non-auto cycle start.
   if (sys.state == STATE_CHECK_MODE) { return(GC_PROBE_CHECK_MODE); }
@@ -264,40 +544,50 @@ uint8_t mc_probe_cycle(float *target, plan_line_data_t *pl_data, uint8_t parser_
     return(GC_PROBE_FAIL_INIT); // Nothing else to do but bail.
   }
 
-  // Setup and queue probing motion. Auto cycle-start should not start the cycle.
-  mc_line(target, pl_data);
-
-  // Activate the probing state monitor in the stepper module.
-  sys_probe_state = PROBE_ACTIVE;
+  #ifdef ENABLE_PROBE_LATCH
+    float start[N_AXIS];
+    system_convert_array_steps_to_mpos(start, sys_position);
+  #endif
 
-  // Perform probing cycle. Wait here until probe is triggered or motion completes.
-  system_set_exec_state_flag(EXEC_CYCLE_START);
-  do {
-    protocol_execute_realtime();
-    if (sys.abort) { return(GC_PROBE_ABORT); } // Check for system abort
-  } while (sys.state != STATE_IDLE);
+  // Seek pass.
+  uint8_t is_triggered = mc_probe_pass(target, pl_data);
+  if (sys.abort) { return(GC_PROBE_ABORT); }
+
+  uint8_t is_seek_touch = false; // Set, if sys_probe_position holds a seek touch the latch missed.
+  #ifdef ENABLE_PROBE_LATCH
+    // Latch pass for probes toward the workpiece. Probing away releases on the seek pass already.
+    if (is_triggered && !is_probe_away) {
+      uint8_t latch = mc_probe_latch(start, target, pl_data);
+      if (sys.abort) { return(GC_PROBE_ABORT); }
+      if (latch == PROBE_LATCH_STUCK) {
+        // The probe didn't release. Not in the expected state to re-touch, like before a cycle.
+        system_set_exec_alarm(EXEC_ALARM_PROBE_FAIL_INITIAL);
+        protocol_execute_realtime();
+        probe_configure_invert_mask(false);
+        return(GC_PROBE_FAIL_INIT);
+      }
+      is_triggered = (latch == PROBE_LATCH_FOUND);
+      is_seek_touch = !is_triggered;
+    }
+  #endif
 
   // Probing cycle complete!
 
   // Set state variables and error out, if the probe failed and cycle with error is enabled.
-  if (sys_probe_state == PROBE_ACTIVE) {
-    if (is_no_error) { memcpy(sys_probe_position, sys_position, sizeof(sys_position)); }
-    else { system_set_exec_alarm(EXEC_ALARM_PROBE_FAIL_CONTACT); }
+  // Without error, a missed latch keeps the seek touch as the probe position.
+  if (!is_triggered) {
+    if (is_no_error) {
+      if (!is_seek_touch) { memcpy(sys_probe_position, sys_position, sizeof(sys_position)); }
+    } else { system_set_exec_alarm(EXEC_ALARM_PROBE_FAIL_CONTACT); }
   } else {
     sys.probe_succeeded = true; // Indicate to system the probing cycle completed successfully.
   }
-  sys_probe_state = PROBE_OFF; // Ensure probe state monitor is disabled.
   probe_configure_invert_mask(false); // Re-initialize invert mask.
   protocol_execute_realtime();   // Check and execute run-time commands
 
-  // Reset the stepper and planner buffers to remove the remainder of the probe motion.
-  st_reset(); // Reset step segment buffer.
-  plan_reset(); // Reset planner buffer. Zero planner positions. Ensure probing motion is cleared.
-  plan_sync_position(); // Sync planner position to current machine position.
-
   #ifdef MESSAGE_PROBE_COORDINATES
     // All done! Output the probe position as message.
-    report_probe_parameters();
+    if (is_reported) { report_probe_parameters(); }
   #endif
 
   if (sys.probe_succeeded) { return(GC_PROBE_FOUND); } // Successful probe cycle.
@@ -305,6 +595,99 @@ uint8_t mc_probe_cycle(float *target, plan_line_data_t *pl_data, uint8_t parser_
 }
 
 
+// G38 probe cycle entry point for the g-code parser.
+uint8_t mc_probe_cycle(float *target, plan_line_data_t *pl_data, uint8_t parser_flags)
+{
+  return(mc_probe_execute(target, pl_data, parser_flags, true));
+}
+
+
+#ifdef ENABLE_HEIGHT_MAP
+  // Moves to the target at rapid rate and waits until there. Not height map corrected.
+  static void mc_height_map_move(float *target, plan_line_data_t *pl_data)
+  {
+    pl_data->condition = PL_COND_FLAG_RAPID_MOTION | gc_state.modal.coolant; // Keep queued coolant.
+    mc_plan_line(target, pl_data);
+    protocol_buffer_synchronize();
+  }
+
+
+  // Probes a grid of nx by ny points over the X by Y size from the current position and stores the
+  // heights in the height map. Points are visited in a serpentine path. Each is probed down by up to
+  // 'depth' below the start height. Between points the tool retracts to the start height or, if
+  // 'clearance' is non-zero, only that far above the last touch. A failed probe raises the usual
+  // probe alarm and leaves the map cleared.
+  uint8_t mc_probe_height_map(float *size, uint8_t *n, float feed_rate, float depth, float clearance)
+  {
+    if (sys.state == STATE_CHECK_MODE) { return(STATUS_OK); }
+    protocol_buffer_synchronize();
+    if (sys.abort) { return(STATUS_OK); }
+
+    probe_height_map_clear(); // Probe without correction. Map is written in place and enabled when done.
+    plan_line_data_t plan_data;
+    plan_line_data_t *pl_data = &plan_data;
+    memset(pl_data,0,sizeof(plan_line_data_t));
+
+    float start[N_AXIS], target[N_AXIS];
+    system_convert_array_steps_to_mpos(start, sys_position);
+    memcpy(target, start, sizeof(start));
+    float spacing[2];
+    spacing[X_AXIS] = size[X_AXIS]/(n[X_AXIS]-1);
+    spacing[Y_AXIS] = size[Y_AXIS]/(n[Y_AXIS]-1);
+
+    float z_travel = start[Z_AXIS];
+    float z_ref = 0.0;
+    uint8_t i, j, k;
+    for (j=0; j<n[Y_AXIS]; j++) {
+      for (k=0; k<n[X_AXIS]; k++) {
+        i = (j & 1) ? (n[X_AXIS]-1-k) : k;
+
+        // Retract in place, then move over to the next point.
+        target[Z_AXIS] = z_travel;
+        mc_height_map_move(target, pl_data);
+        target[X_AXIS] = start[X_AXIS]+i*spacing[X_AXIS];
+        target[Y_AXIS] = start[Y_AXIS]+j*spacing[Y_AXIS];
+        mc_height_map_move(target, pl_data);
+        if (sys.abort) { return(STATUS_OK); }
+
+        target[Z_AXIS] = start[Z_AXIS]-depth;
+        pl_data->condition = gc_state.modal.coolant;
+        #ifndef ALLOW_FEED_OVERRIDE_DURING_PROBE_CYCLES
+          pl_data->condition |= PL_COND_FLAG_NO_FEED_OVERRIDE;
+        #endif
+        pl_data->feed_rate = feed_rate;
+        // No [PRB:] report per point. Senders would take each for a completed G38.
+        if (mc_probe_execute(target, pl_data, GC_PARSER_NONE, false) != GC_PROBE_FOUND) { return(STATUS_OK); }
+
+        float z_touch = system_convert_axis_steps_to_mpos(sys_probe_position, Z_AXIS);
+        if ((i == 0) && (j == 0)) { z_ref = z_touch; }
+        float z = 1000.0*(z_touch-z_ref);
+        if (z > INT16_MAX) { z = INT16_MAX; }
+        else if (z < -INT16_MAX) { z = -INT16_MAX; }
+        height_map.z[j*n[X_AXIS]+i] = lround(z);
+        if (clearance > 0.0) { z_travel = min(start[Z_AXIS], z_touch+clearance); }
+        target[Z_AXIS] = z_touch;
+      }
+    }
+
+    // Return to the start position and enable the map.
+    target[Z_AXIS] = start[Z_AXIS];
+    mc_height_map_move(target, pl_data);
+    mc_height_map_move(start, pl_data);
+    if (sys.abort) { return(STATUS_OK); }
+    gc_sync_position();
+    height_map.origin[X_AXIS] = start[X_AXIS];
+    height_map.origin[Y_AXIS] = start[Y_AXIS];
+    height_map.spacing[X_AXIS] = spacing[X_AXIS];
+    height_map.spacing[Y_AXIS] = spacing[Y_AXIS];
+    height_map.n[Y_AXIS] = n[Y_AXIS];
+    height_map.n[X_AXIS] = n[X_AXIS]; // Set last. Enables the map.
+    report_height_map();
+    return(STATUS_OK);
+  }
+#endif
+
+
 // Plans and executes the single special motion case for parking. Independent of main planner buffer.
 // NOTE: Uses the always free planner ring buffer head to store motion parameters for execution.
 #ifdef PARKING_ENABLE
@@ -355,6 +738,7 @@ void mc_reset()
   // Only this function can set the system reset. Helps prevent multiple kill calls.
   if (bit_isfalse(sys_rt_exec_state, EXEC_RESET)) {
     system_set_exec_state_flag(EXEC_RESET);
+    arc.segments = 0; // Drop any pending arc chords.
 
     // Kill spindle and coolant.
     spindle_stop();
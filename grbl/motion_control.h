@@ -45,8 +45,14 @@ void mc_line(float *target, plan_line_data_t *pl_data);
 void mc_arc(float *target, plan_line_data_t *pl_data, float *position, float *offset, float radius,
   uint8_t axis_0, uint8_t axis_1, uint8_t axis_linear, uint8_t is_clockwise_arc);
 
+// Queue chords of a pending arc into free planner blocks. Called by the main loop.
+void mc_arc_continue();
+
+// Queue all remaining chords of a pending arc. Blocks until done.
+void mc_arc_finish();
+
 // Dwell for a specific number of seconds
-void mc_dwell(float seconds);
+void mc_dwell(float seconds, plan_line_data_t *pl_data);
 
 // Perform homing cycle to locate machine zero. Requires limit switches.
 void mc_homing_cycle(uint8_t cycle_mask);
@@ -54,6 +60,11 @@ void mc_homing_cycle(uint8_t cycle_mask);
 // Perform tool length probe cycle. Requires probe switch.
 uint8_t mc_probe_cycle(float *target, plan_line_data_t *pl_data, uint8_t parser_flags);
 
+#ifdef ENABLE_HEIGHT_MAP
+  // Probes a grid of surface heights for the height map, starting at the current position.
+  uint8_t mc_probe_height_map(float *size, uint8_t *n, float feed_rate, float depth, float clearance);
+#endif
+
 // Handles updating the override control state.
 void mc_override_ctrl_update(uint8_t override_state);
 
@@ -108,21 +108,90 @@ uint8_t read_float(char *line, uint8_t *char_counter, float *float_ptr)
 }
 
 
-// Non-blocking delay function used for general operation and suspend features.
-void delay_sec(float seconds, uint8_t mode)
+#ifdef ENABLE_GCODE_FIXED_POINT
+// Extracts a decimal value from a string as a fixed-point integer scaled by FIXED_POINT_SCALE,
+// without any floating point operations. Follows the same format rules as read_float(). Digits
+// past the fixed-point resolution are rounded on the first dropped digit. Returns false on a
+// missing number or if the value doesn't fit into an int32.
+uint8_t read_fixed(char *line, uint8_t *char_counter, int32_t *fixed_ptr)
 {
- 	uint16_t i = ceil(1000/DWELL_TIME_STEP*seconds);
-	while (i-- > 0) {
-		if (sys.abort) { return; }
-		if (mode == DELAY_MODE_DWELL) {
-			protocol_execute_realtime();
-		} else { // DELAY_MODE_SYS_SUSPEND
-		  // Execute rt_system() only to avoid nesting suspend loops.
-		  protocol_exec_rt_system();
-		  if (sys.suspend & SUSPEND_RESTART_RETRACT) { return; } // Bail, if safety door reopens.
-		}
-		_delay_ms(DWELL_TIME_STEP); // Delay DWELL_TIME_STEP increment
-	}
+  char *ptr = line + *char_counter;
+  unsigned char c;
+
+  // Grab first character and increment pointer. No spaces assumed in line.
+  c = *ptr++;
+
+  // Capture initial positive/minus character
+  bool isnegative = false;
+  if (c == '-') {
+    isnegative = true;
+    c = *ptr++;
+  } else if (c == '+') {
+    c = *ptr++;
+  }
+
+  // Extract number directly into scaled integer. Track number of decimals read, if any.
+  uint32_t intval = 0;
+  int8_t ndecimal = -1; // Negative until the decimal point is found.
+  uint8_t ndigit = 0;
+  uint8_t round_up = false;
+  while(1) {
+    c -= '0';
+    if (c <= 9) {
+      ndigit++;
+      if (ndecimal < FIXED_POINT_DIGITS) {
+        if (intval > MAX_FIXED_INTVAL) { return(false); } // Overflow.
+        intval = (((intval << 2) + intval) << 1) + c; // intval*10 + c
+        if (ndecimal >= 0) { ndecimal++; }
+      } else if (ndecimal == FIXED_POINT_DIGITS) {
+        if (c >= 5) { round_up = true; } // Round on first dropped digit. Ignore the rest.
+        ndecimal++;
+      }
+    } else if (c == (('.'-'0') & 0xff)  &&  (ndecimal < 0)) {
+      ndecimal = 0;
+    } else {
+      break;
+    }
+    c = *ptr++;
+  }
+
+  // Return if no digits have been read.
+  if (!ndigit) { return(false); };
+
+  // Scale up to the fixed-point resolution, if fewer decimals were given.
+  if (ndecimal < 0) { ndecimal = 0; }
+  while (ndecimal < FIXED_POINT_DIGITS) {
+    if (intval > MAX_FIXED_INTVAL) { return(false); }
+    intval = (((intval << 2) + intval) << 1);
+    ndecimal++;
+  }
+  if (round_up) { intval++; }
+
+  // Assign fixed-point value with correct sign.
+  if (isnegative) {
+    *fixed_ptr = -(int32_t)intval;
+  } else {
+    *fixed_ptr = intval;
+  }
+
+  *char_counter = ptr - line - 1; // Set char_counter to next statement
+
+  return(true);
+}
+#endif
+
+
+// Non-blocking delay function used for suspend features. Waits on a system tick deadline, and
+// keeps servicing realtime commands, like status reports, every pass instead of every 50ms step.
+void delay_sec(float seconds)
+{
+  uint32_t deadline = system_set_deadline(lround(1000.0*seconds));
+  while (!system_deadline_passed(deadline)) {
+    if (sys.abort) { return; }
+    // Execute rt_system() only to avoid nesting suspend loops.
+    protocol_exec_rt_system();
+    if (sys.suspend & SUSPEND_RESTART_RETRACT) { return; } // Bail, if safety door reopens.
+  }
 }
 
 
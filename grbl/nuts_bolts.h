@@ -46,9 +46,6 @@
 #define INCH_PER_MM (0.0393701)
 #define TICKS_PER_MICROSECOND (F_CPU/1000000)
 
-#define DELAY_MODE_DWELL       0
-#define DELAY_MODE_SYS_SUSPEND 1
-
 // Useful macros
 #define clear_vector(a) memset(a, 0, sizeof(a))
 #define clear_vector_float(a) memset(a, 0.0, sizeof(float)*N_AXIS)
@@ -69,8 +66,21 @@
 // a pointer to the result variable. Returns true when it succeeds
 uint8_t read_float(char *line, uint8_t *char_counter, float *float_ptr);
 
-// Non-blocking delay function used for general operation and suspend features.
-void delay_sec(float seconds, uint8_t mode);
+#ifdef ENABLE_GCODE_FIXED_POINT
+  // Fixed-point coordinate resolution. Values are stored as integers in 10^-FIXED_POINT_DIGITS units.
+  #define FIXED_POINT_DIGITS 4
+  #define FIXED_POINT_SCALE 10000L
+  #define MAX_FIXED_INTVAL ((INT32_MAX-9)/10) // Largest value that may still be multiplied by ten.
+  #define FIXED_POINT_MAX 0x3FFFFFFFL // Largest coordinate or offset magnitude. Sum of two fits int32.
+  #define FIXED_POINT_MAX_INCH (INT32_MAX/254) // Largest inch value that may be multiplied by 254.
+
+  // Read a decimal value from a string as a fixed-point integer scaled by FIXED_POINT_SCALE. Same
+  // input conventions as read_float(). Returns true when it succeeds.
+  uint8_t read_fixed(char *line, uint8_t *char_counter, int32_t *fixed_ptr);
+#endif
+
+// Non-blocking delay function used for suspend features. Driven by the system tick.
+void delay_sec(float seconds);
 
 // Delays variable-defined milliseconds. Compiler compatibility fix for _delay_ms().
 void delay_ms(uint16_t ms);
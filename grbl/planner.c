@@ -23,7 +23,12 @@
 #include "grbl.h"
 
 
-static plan_block_t block_buffer[BLOCK_BUFFER_SIZE];  // A ring buffer for motion instructions
+#ifdef ENABLE_BUFFER_RAM_BUDGET
+  static plan_block_t *block_buffer;  // A ring buffer for motion instructions. Carved from free SRAM.
+  uint8_t plan_block_buffer_size;
+#else
+  static plan_block_t block_buffer[BLOCK_BUFFER_SIZE];  // A ring buffer for motion instructions
+#endif
 static uint8_t block_buffer_tail;     // Index of the block to process now
 static uint8_t block_buffer_head;     // Index of the next block to be pushed
 static uint8_t next_buffer_head;      // Index of the next buffer head
@@ -39,6 +44,23 @@ typedef struct {
 } planner_t;
 static planner_t pl;
 
+#ifdef ENABLE_BACKLASH_COMPENSATION
+  // Last direction of each axis, as direction pin bits, at the end of the planned motion and of the
+  // motion loaded by the stepper. Kept outside of the planner struct, since the slack in the drive
+  // train outlasts a planner reset. Before an axis has moved, its direction is taken as positive.
+  static uint8_t backlash_dir_planned;
+  static uint8_t backlash_dir_loaded;
+#endif
+
+
+#ifdef ENABLE_BUFFER_RAM_BUDGET
+  void plan_set_block_buffer(plan_block_t *buffer, uint8_t size)
+  {
+    block_buffer = buffer;
+    plan_block_buffer_size = size;
+  }
+#endif
+
 
 // Returns the index of the next block in the ring buffer. Also called by stepper segment buffer.
 uint8_t plan_next_block_index(uint8_t block_index)
@@ -377,9 +399,41 @@ uint8_t plan_buffer_line(float *target, plan_line_data_t *pl_data)
     if (delta_mm < 0.0 ) { block->direction_bits |= get_direction_pin_mask(idx); }
   }
 
+  // Soft limits are checked here in the step domain, after the conversion the block executes with.
+  // NOTE: System motions, i.e. homing and parking, are exempt. Jog targets are checked on receipt.
+  if (bit_istrue(settings.flags,BITFLAG_SOFT_LIMIT_ENABLE)) {
+    if (!(block->condition & PL_COND_FLAG_SYSTEM_MOTION) && (sys.state != STATE_JOG)) {
+      if (system_check_travel_steps(target_steps)) { return(PLAN_TRAVEL_EXCEEDED); }
+    }
+  }
+
   // Bail if this is a zero-length block. Highly unlikely to occur.
   if (block->step_event_count == 0) { return(PLAN_EMPTY_BLOCK); }
 
+  #ifdef ENABLE_BACKLASH_COMPENSATION
+    // Merge the backlash of axes reversing direction into this block, so the correction costs no stop.
+    // The extra steps count into the block geometry and rates, as the motors have to make them, but
+    // not into the planner position. The stepper executes them first and skips them in sys_position.
+    if (!(block->condition & PL_COND_FLAG_SYSTEM_MOTION)) {
+      for (idx=0; idx<N_AXIS; idx++) {
+        if (block->steps[idx]) {
+          uint8_t dir_mask = get_direction_pin_mask(idx);
+          if ((backlash_dir_planned ^ block->direction_bits) & dir_mask) {
+            uint16_t backlash_steps = plan_get_backlash_steps(idx);
+            if (backlash_steps) {
+              block->backlash_axes |= bit(idx);
+              block->steps[idx] += backlash_steps;
+              block->step_event_count = max(block->step_event_count, block->steps[idx]);
+              if (block->direction_bits & dir_mask) { unit_vec[idx] -= backlash_steps/settings.steps_per_mm[idx]; }
+              else { unit_vec[idx] += backlash_steps/settings.steps_per_mm[idx]; }
+            }
+            backlash_dir_planned ^= dir_mask;
+          }
+        }
+      }
+    }
+  #endif
+
   // Calculate the unit vector of the line move and the block maximum feed rate and acceleration scaled
   // down such that no individual axes maximum values are exceeded with respect to the line direction.
   // NOTE: This calculation assumes all axes are orthogonal (Cartesian) and works with ABC-axes,
@@ -472,6 +526,27 @@ uint8_t plan_buffer_line(float *target, plan_line_data_t *pl_data)
 }
 
 
+// Add a dwell to the buffer. A dwell block has no steps and is executed by the stepper ISR as step-less
+// segments of the dwell time. It is identified by its zero step event count, which no line block
+// has. Its zero max entry speed and acceleration make the planner passes stop the motion before it
+// and start the next one from rest, like a buffer sync would, but without draining the buffer.
+// The block carries the spindle and coolant condition, so queued accessory states hold during it.
+// NOTE: Assumes buffer is available. Buffer checks are handled at a higher level by motion_control.
+void plan_buffer_dwell(float seconds, plan_line_data_t *pl_data)
+{
+  plan_block_t *block = &block_buffer[block_buffer_head];
+  memset(block,0,sizeof(plan_block_t)); // Zero all block values.
+  block->condition = pl_data->condition;
+  block->millimeters = 1000.0*seconds; // Dwell time (ms)
+  pl.previous_nominal_speed = 0.0; // Next motion starts from rest.
+
+  // New block is all set. Update buffer head and next buffer head indices.
+  block_buffer_head = next_buffer_head;
+  next_buffer_head = plan_next_block_index(block_buffer_head);
+  planner_recalculate();
+}
+
+
 // Reset the planner position vectors. Called by the system abort/initialization routine.
 void plan_sync_position()
 {
@@ -491,6 +566,44 @@ void plan_sync_position()
       pl.position[idx] = sys_position[idx];
     #endif
   }
+  #ifdef ENABLE_BACKLASH_COMPENSATION
+    backlash_dir_planned = backlash_dir_loaded; // Flushed blocks never moved the machine.
+  #endif
+}
+
+
+#ifdef ENABLE_BACKLASH_COMPENSATION
+  // Returns the backlash setting of an axis in steps. Called for each compensated block by the planner
+  // and again by the stepper segment prep, which gets the same value, since settings only change idle.
+  // NOTE: Settings are checked against BACKLASH_STEPS_MAX when stored. Clamped here as well, so
+  // settings from an older EEPROM can't wrap the 16-bit step count.
+  uint16_t plan_get_backlash_steps(uint8_t idx)
+  {
+    float steps = settings.backlash[idx]*settings.steps_per_mm[idx];
+    if (steps > BACKLASH_STEPS_MAX) { return(BACKLASH_STEPS_MAX); }
+    return(lround(steps));
+  }
+
+
+  // Tracks the axes directions of the block loaded by the stepper segment prep. These are the
+  // directions the machine has actually moved in, once all motion is complete.
+  void plan_set_backlash_dir_loaded(plan_block_t *block)
+  {
+    uint8_t idx;
+    for (idx=0; idx<N_AXIS; idx++) {
+      if (block->steps[idx]) {
+        uint8_t dir_mask = get_direction_pin_mask(idx);
+        backlash_dir_loaded = (backlash_dir_loaded & ~dir_mask) | (block->direction_bits & dir_mask);
+      }
+    }
+  }
+#endif
+
+
+// Returns the planner end position, i.e. the target of the last queued block, in machine coordinates.
+void plan_get_planner_mpos(float *target)
+{
+  system_convert_array_steps_to_mpos(target, pl.position);
 }
 
 
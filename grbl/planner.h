@@ -26,15 +26,25 @@
 // The number of linear motions that can be in the plan at any give time
 #ifndef BLOCK_BUFFER_SIZE
   #ifdef USE_LINE_NUMBERS
-    #define BLOCK_BUFFER_SIZE 15
+    #define BLOCK_BUFFER_DEFAULT_SIZE 15
   #else
-    #define BLOCK_BUFFER_SIZE 16
+    #define BLOCK_BUFFER_DEFAULT_SIZE 16
   #endif
+  #ifdef ENABLE_BUFFER_RAM_BUDGET
+    // Planner buffer size set at power-up by plan_set_block_buffer(). Limited to 8-bit indexing.
+    extern uint8_t plan_block_buffer_size;
+    #define BLOCK_BUFFER_SIZE plan_block_buffer_size
+  #else
+    #define BLOCK_BUFFER_SIZE BLOCK_BUFFER_DEFAULT_SIZE
+  #endif
+#elif defined(ENABLE_BUFFER_RAM_BUDGET)
+  #error "BLOCK_BUFFER_SIZE can't be set with ENABLE_BUFFER_RAM_BUDGET. It is sized at power-up."
 #endif
 
 // Returned status message from planner.
 #define PLAN_OK true
 #define PLAN_EMPTY_BLOCK false
+#define PLAN_TRAVEL_EXCEEDED 2 // Soft limit violation. Block not planned.
 
 // Define planner data condition flags. Used to denote running conditions of a block.
 #define PL_COND_FLAG_RAPID_MOTION      bit(0)
@@ -47,6 +57,7 @@
 #define PL_COND_FLAG_COOLANT_MIST      bit(7)
 #define PL_COND_MOTION_MASK    (PL_COND_FLAG_RAPID_MOTION|PL_COND_FLAG_SYSTEM_MOTION|PL_COND_FLAG_NO_FEED_OVERRIDE)
 #define PL_COND_ACCESSORY_MASK (PL_COND_FLAG_SPINDLE_CW|PL_COND_FLAG_SPINDLE_CCW|PL_COND_FLAG_COOLANT_FLOOD|PL_COND_FLAG_COOLANT_MIST)
+#define PL_COND_COOLANT_MASK   (PL_COND_FLAG_COOLANT_FLOOD|PL_COND_FLAG_COOLANT_MIST)
 
 
 // This struct stores a linear movement of a g-code block motion with its critical "nominal" values
@@ -57,6 +68,9 @@ typedef struct {
   uint32_t steps[N_AXIS];    // Step count along each axis
   uint32_t step_event_count; // The maximum step axis count and number of steps required to complete this block.
   uint8_t direction_bits;    // The direction bit set for this block (refers to *_DIRECTION_BIT in config.h)
+  #ifdef ENABLE_BACKLASH_COMPENSATION
+    uint8_t backlash_axes;   // Axes with backlash steps included in steps[]. See plan_get_backlash_steps().
+  #endif
 
   // Block condition data to ensure correct execution depending on states and overrides.
   uint8_t condition;      // Block bitflag variable defining block run conditions. Copied from pl_line_data.
@@ -71,6 +85,7 @@ typedef struct {
                              //   neighboring nominal speeds with overrides in (mm/min)^2
   float acceleration;        // Axis-limit adjusted line acceleration in (mm/min^2). Does not change.
   float millimeters;         // The remaining distance for this block to be executed in (mm).
+                             // NOTE: Remaining dwell time in (ms) for dwell blocks. See plan_buffer_dwell().
                              // NOTE: This value may be altered by stepper algorithm during execution.
 
   // Stored rate limiting data used by planner when changes occur.
@@ -97,6 +112,11 @@ typedef struct {
 
 
 // Initialize and reset the motion plan subsystem
+#ifdef ENABLE_BUFFER_RAM_BUDGET
+  // Sets the planner ring buffer memory. Called once at power-up, before plan_reset().
+  void plan_set_block_buffer(plan_block_t *buffer, uint8_t size);
+#endif
+
 void plan_reset(); // Reset all
 void plan_reset_buffer(); // Reset buffer only.
 
@@ -105,6 +125,9 @@ void plan_reset_buffer(); // Reset buffer only.
 // rate is taken to mean "frequency" and would complete the operation in 1/feed_rate minutes.
 uint8_t plan_buffer_line(float *target, plan_line_data_t *pl_data);
 
+// Add a dwell of the given seconds to the buffer. Motion stops before it and starts from rest after it.
+void plan_buffer_dwell(float seconds, plan_line_data_t *pl_data);
+
 // Called when the current block is no longer needed. Discards the block and makes the memory
 // availible for new blocks.
 void plan_discard_current_block();
@@ -143,6 +166,17 @@ uint8_t plan_get_block_buffer_count();
 // Returns the status of the block ring buffer. True, if buffer is full.
 uint8_t plan_check_full_buffer();
 
+#ifdef ENABLE_BACKLASH_COMPENSATION
+  #define BACKLASH_STEPS_MAX 65535 // Backlash is counted in 16-bit steps by the planner and stepper.
+
+  // Returns the backlash setting of an axis in steps.
+  uint16_t plan_get_backlash_steps(uint8_t idx);
+
+  // Tracks the axes directions of the block loaded by the stepper segment prep.
+  void plan_set_backlash_dir_loaded(plan_block_t *block);
+#endif
+
+// Returns the planner end position, i.e. the target of the last queued block, in machine coordinates.
 void plan_get_planner_mpos(float *target);
 
 
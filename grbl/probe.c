@@ -24,6 +24,10 @@
 // Inverts the probe pin state depending on user settings and probing cycle mode.
 uint8_t probe_invert_mask;
 
+#ifdef ENABLE_HEIGHT_MAP
+  height_map_t height_map;
+#endif
+
 
 // Probe pin initialization routine.
 void probe_init()
@@ -64,3 +68,34 @@ void probe_state_monitor()
     bit_true(sys_rt_exec_state, EXEC_MOTION_CANCEL);
   }
 }
+
+
+#ifdef ENABLE_HEIGHT_MAP
+  void probe_height_map_clear() { height_map.n[X_AXIS] = 0; height_map.n[Y_AXIS] = 0; }
+
+
+  // Returns the bilinear interpolated surface height at the machine XY position. The grid cell is
+  // found directly from the spacing, so the lookup time is independent of the grid size.
+  float probe_height_map_get_z(float x, float y)
+  {
+    if (!height_map.n[X_AXIS]) { return(0.0); }
+    float u[2];
+    uint8_t cell[2];
+    uint8_t idx;
+    u[X_AXIS] = (x-height_map.origin[X_AXIS])/height_map.spacing[X_AXIS];
+    u[Y_AXIS] = (y-height_map.origin[Y_AXIS])/height_map.spacing[Y_AXIS];
+    for (idx=0; idx<2; idx++) {
+      float u_max = height_map.n[idx]-1;
+      if (u[idx] < 0.0) { u[idx] = 0.0; }
+      else if (u[idx] > u_max) { u[idx] = u_max; }
+      cell[idx] = trunc(u[idx]);
+      if (cell[idx] > height_map.n[idx]-2) { cell[idx] = height_map.n[idx]-2; }
+      u[idx] -= cell[idx]; // Fraction within cell.
+    }
+    int16_t *z = &height_map.z[cell[Y_AXIS]*height_map.n[X_AXIS]+cell[X_AXIS]];
+    float z_low = z[0] + u[X_AXIS]*(z[1]-z[0]);
+    z += height_map.n[X_AXIS];
+    float z_high = z[0] + u[X_AXIS]*(z[1]-z[0]);
+    return(0.001*(z_low + u[Y_AXIS]*(z_high-z_low)));
+  }
+#endif
@@ -40,4 +40,23 @@ uint8_t probe_get_state();
 // stepper ISR per ISR tick.
 void probe_state_monitor();
 
+#ifdef ENABLE_HEIGHT_MAP
+  #define HEIGHT_MAP_EPSILON 1E-6 // Float (mm and line fraction)
+
+  // Surface height map over a grid of probed points in machine coordinates.
+  typedef struct {
+    uint8_t n[2];                      // Number of grid points in X and Y. Map disabled when zero.
+    float origin[2];                   // Machine XY of the first grid point.
+    float spacing[2];                  // Distance between grid points in X and Y.
+    int16_t z[HEIGHT_MAP_MAX_POINTS];  // Heights relative to the first point in micrometers. Row-major in Y.
+  } height_map_t;
+  extern height_map_t height_map;
+
+  // Clears the height map and disables Z compensation.
+  void probe_height_map_clear();
+
+  // Returns the bilinear interpolated surface height at the machine XY position. Clamped to the grid edges.
+  float probe_height_map_get_z(float x, float y);
+#endif
+
 #endif
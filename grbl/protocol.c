@@ -31,6 +31,12 @@ static char line[LINE_BUFFER_SIZE]; // Line to be executed. Zero-terminated.
 
 static void protocol_exec_rt_suspend();
 
+#ifdef REPORT_FEED_HOLD_LATENCY
+  static uint8_t hold_timing = false;     // Set while a feed hold is being timed.
+  static uint32_t hold_start_tick;        // System tick of the hold request. (ms)
+  static int32_t hold_start_position[N_AXIS]; // Machine position at the hold request. (steps)
+#endif
+
 
 /*
   GRBL PRIMARY LOOP:
@@ -52,6 +58,12 @@ void protocol_main_loop()
   if (sys.state & (STATE_ALARM | STATE_SLEEP)) {
     report_feedback_message(MESSAGE_ALARM_LOCK);
     sys.state = STATE_ALARM; // Ensure alarm state is set.
+    #ifdef BUNGARD_HOMING_TRUSTED_POSITION
+      limits_invalidate_home();
+    #endif
+    #ifdef ENABLE_POSITION_RESTORE
+      system_invalidate_position();
+    #endif
   } else {
     // Check if the safety door is open.
     sys.state = STATE_IDLE;
@@ -71,11 +83,17 @@ void protocol_main_loop()
   uint8_t line_flags = 0;
   uint8_t char_counter = 0;
   uint8_t c;
+  #ifdef ENABLE_PROGRAM_MODE
+    uint32_t program_start_deadline = 0; // System tick at which quiet input starts a program-mode cycle.
+  #endif
   for (;;) {
 
     // Process one line of incoming serial data, as the data becomes available. Performs an
     // initial filtering by removing spaces and comments and capitalizing all letters.
     while((c = serial_read()) != SERIAL_NO_DATA) {
+      #ifdef ENABLE_PROGRAM_MODE
+        program_start_deadline = system_set_deadline(PROGRAM_MODE_START_DELAY);
+      #endif
       if ((c == '\n') || (c == '\r')) { // End of line reached
 
         protocol_execute_realtime(); // Runtime command check point.
@@ -131,13 +149,13 @@ void protocol_main_loop()
           } else if (c == ';') {
             // NOTE: ';' comment to EOL is a LinuxCNC definition. Not NIST.
             line_flags |= LINE_FLAG_COMMENT_SEMICOLON;
-          // TODO: Install '%' feature
-          // } else if (c == '%') {
-            // Program start-end percent sign NOT SUPPORTED.
-            // NOTE: This maybe installed to tell Grbl when a program is running vs manual input,
-            // where, during a program, the system auto-cycle start will continue to execute
-            // everything until the next '%' sign. This will help fix resuming issues with certain
-            // functions that empty the planner buffer to execute its task on-time.
+          #ifdef ENABLE_PROGRAM_MODE
+          } else if (c == '%') {
+            // Program start-end percent sign. Toggles program mode and is otherwise ignored, so the
+            // line is treated as empty and acknowledged with an 'ok' like any other line.
+            // NOTE: Upon exiting, the main loop auto-cycle starts whatever remains in the buffer.
+            sys.program_mode = !sys.program_mode;
+          #endif
           } else if (char_counter >= (LINE_BUFFER_SIZE-1)) {
             // Detect line buffer overflow and set flag.
             line_flags |= LINE_FLAG_OVERFLOW;
@@ -151,10 +169,30 @@ void protocol_main_loop()
       }
     }
 
+    mc_arc_continue(); // Generate pending arc chords, as planner blocks free up.
+    #ifdef ENABLE_CONTINUOUS_JOG
+      jog_continuous_update(); // Keep the continuous jog horizon queued.
+    #endif
+    #ifdef ENABLE_COORD_DATA_CACHE
+      settings_write_back_coord_data(); // Deferred EEPROM write of changed coordinate data.
+    #endif
+
     // If there are no more characters in the serial read buffer to be processed and executed,
     // this indicates that g-code streaming has either filled the planner buffer or has
     // completed. In either case, auto-cycle start, if enabled, any queued moves.
-    protocol_auto_cycle_start();
+    #ifdef ENABLE_PROGRAM_MODE
+      // In program mode, an empty serial buffer more likely means the host is momentarily slow.
+      // Keep priming the planner instead of starting a cycle that would immediately starve, until
+      // the buffer is full or the input has been quiet for PROGRAM_MODE_START_DELAY.
+      if (sys.program_mode && (sys.state == STATE_IDLE) && !plan_check_full_buffer() &&
+          !system_deadline_passed(program_start_deadline)) {
+        // Wait out the quiet time. The rest of the main loop keeps running meanwhile.
+      } else {
+        protocol_auto_cycle_start();
+      }
+    #else
+      protocol_auto_cycle_start();
+    #endif
 
     protocol_execute_realtime();  // Runtime command check point.
     if (sys.abort) { return; } // Bail to main() program loop to reset system.
@@ -168,6 +206,7 @@ void protocol_main_loop()
 // during a synchronize call, if it should happen. Also, waits for clean cycle end.
 void protocol_buffer_synchronize()
 {
+  mc_arc_finish(); // Queue any pending arc chords first.
   // If system is queued, ensure cycle resumes if the auto start flag is present.
   protocol_auto_cycle_start();
   do {
@@ -221,6 +260,12 @@ void protocol_exec_rt_system()
     // the source of the error to the user. If critical, Grbl disables by entering an infinite
     // loop until system reset/abort.
     sys.state = STATE_ALARM; // Set system alarm state
+    #ifdef BUNGARD_HOMING_TRUSTED_POSITION
+      limits_invalidate_home(); // Position may be lost.
+    #endif
+    #ifdef ENABLE_POSITION_RESTORE
+      system_invalidate_position();
+    #endif
     report_alarm_message(rt_exec);
     // Halt everything upon a critical event flag. Currently hard and soft limits flag this.
     if ((rt_exec == EXEC_ALARM_HARD_LIMIT) || (rt_exec == EXEC_ALARM_SOFT_LIMIT)) {
@@ -262,6 +307,16 @@ void protocol_exec_rt_system()
         // If in CYCLE or JOG states, immediately initiate a motion HOLD.
         if (sys.state & (STATE_CYCLE | STATE_JOG)) {
           if (!(sys.suspend & (SUSPEND_MOTION_CANCEL | SUSPEND_JOG_CANCEL))) { // Block, if already holding.
+            #ifdef REPORT_FEED_HOLD_LATENCY
+              if (!(sys.step_control & STEP_CONTROL_EXECUTE_HOLD)) {
+                hold_timing = true;
+                hold_start_tick = system_get_tick();
+                memcpy(hold_start_position,sys_position,sizeof(sys_position));
+              }
+            #endif
+            #ifdef ENABLE_FAST_FEED_HOLD
+              st_truncate_segment_buffer(); // Start the deceleration after the next segment.
+            #endif
             st_update_plan_block_parameters(); // Notify stepper module to recompute for hold deceleration.
             sys.step_control = STEP_CONTROL_EXECUTE_HOLD; // Initiate suspend state with active flag.
             if (sys.state == STATE_JOG) { // Jog cancelled upon any hold event, except for sleeping.
@@ -322,6 +377,9 @@ void protocol_exec_rt_system()
       if (rt_exec & EXEC_SLEEP) {
         if (sys.state == STATE_ALARM) { sys.suspend |= (SUSPEND_RETRACT_COMPLETE|SUSPEND_HOLD_COMPLETE); }
         sys.state = STATE_SLEEP; 
+        #ifdef ENABLE_POSITION_RESTORE
+          system_invalidate_position(); // Steppers are disabled in sleep.
+        #endif
       }
 
       system_clear_exec_state_flag((EXEC_MOTION_CANCEL | EXEC_FEED_HOLD | EXEC_SAFETY_DOOR | EXEC_SLEEP));
@@ -378,10 +436,19 @@ void protocol_exec_rt_system()
         // has issued a resume command or reset.
         plan_cycle_reinitialize();
         if (sys.step_control & STEP_CONTROL_EXECUTE_HOLD) { sys.suspend |= SUSPEND_HOLD_COMPLETE; }
+        #ifdef REPORT_FEED_HOLD_LATENCY
+          if (hold_timing) {
+            hold_timing = false;
+            report_feed_hold_latency(system_get_tick()-hold_start_tick,hold_start_position);
+          }
+        #endif
         bit_false(sys.step_control,(STEP_CONTROL_EXECUTE_HOLD | STEP_CONTROL_EXECUTE_SYS_MOTION));
       } else {
         // Motion complete. Includes CYCLE/JOG/HOMING states and jog cancel/motion cancel/soft limit events.
         // NOTE: Motion and jog cancel both immediately return to idle after the hold completes.
+        #ifdef REPORT_FEED_HOLD_LATENCY
+          hold_timing = false;
+        #endif
         if (sys.suspend & SUSPEND_JOG_CANCEL) {   // For jog cancel, flush buffers and sync positions.
           sys.step_control = STEP_CONTROL_NORMAL_OP;
           plan_reset();
@@ -396,8 +463,15 @@ void protocol_exec_rt_system()
         } else {
           sys.suspend = SUSPEND_DISABLE;
           sys.state = STATE_IDLE;
+          #ifdef ENABLE_QUEUED_COOLANT
+            coolant_apply_pending(); // Coolant change programmed after the last motion.
+          #endif
         }
       }
+      #ifdef ENABLE_POSITION_RESTORE
+        // Machine is at rest after a controlled stop. Position survives a reset from here.
+        if (!sys_rt_exec_alarm) { system_validate_position(); }
+      #endif
       system_clear_exec_state_flag(EXEC_CYCLE_STOP);
     }
   }
@@ -460,7 +534,8 @@ void protocol_exec_rt_system()
     }
 
     // NOTE: Since coolant state always performs a planner sync whenever it changes, the current
-    // run state can be determined by checking the parser state.
+    // run state can be determined by checking the parser state. With queued coolant, the parser
+    // state may be ahead of the outputs by a block. A programmed change still applies at its block.
     if (rt_exec & (EXEC_COOLANT_FLOOD_OVR_TOGGLE | EXEC_COOLANT_MIST_OVR_TOGGLE)) {
       if ((sys.state == STATE_IDLE) || (sys.state & (STATE_CYCLE | STATE_HOLD))) {
         uint8_t coolant_state = gc_state.modal.coolant;
@@ -672,7 +747,7 @@ static void protocol_exec_rt_suspend()
                   bit_true(sys.step_control, STEP_CONTROL_UPDATE_SPINDLE_PWM);
                 } else {
                   spindle_set_state((restore_condition & (PL_COND_FLAG_SPINDLE_CW | PL_COND_FLAG_SPINDLE_CCW)), restore_spindle_speed);
-                  delay_sec(SAFETY_DOOR_SPINDLE_DELAY, DELAY_MODE_SYS_SUSPEND);
+                  delay_sec(SAFETY_DOOR_SPINDLE_DELAY);
                 }
               }
             }
@@ -681,7 +756,7 @@ static void protocol_exec_rt_suspend()
               if (bit_isfalse(sys.suspend,SUSPEND_RESTART_RETRACT)) {
                 // NOTE: Laser mode will honor this delay. An exhaust system is often controlled by this pin.
                 coolant_set_state((restore_condition & (PL_COND_FLAG_COOLANT_FLOOD | PL_COND_FLAG_COOLANT_FLOOD)));
-                delay_sec(SAFETY_DOOR_COOLANT_DELAY, DELAY_MODE_SYS_SUSPEND);
+                delay_sec(SAFETY_DOOR_COOLANT_DELAY);
               }
             }
 
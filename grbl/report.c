@@ -84,6 +84,7 @@ static void report_util_setting_string(uint8_t n) {
         case 1: printPgmString(PSTR(":mm/min")); break;
         case 2: printPgmString(PSTR(":mm/s^2")); break;
         case 3: printPgmString(PSTR(":mm max")); break;
+        case 4: printPgmString(PSTR(":mm bklsh")); break;
       }
       break;
   }
@@ -127,7 +128,9 @@ void report_alarm_message(uint8_t alarm_code)
   printPgmString(PSTR("ALARM:"));
   print_uint8_base10(alarm_code);
   report_util_line_feed();
-  delay_ms(500); // Force delay to ensure message clears serial write buffer.
+  // Wait for the message to clear the serial write buffer, but no longer than the old fixed 500ms.
+  uint32_t deadline = system_set_deadline(500);
+  while (serial_get_tx_buffer_count() && !system_deadline_passed(deadline)) {}
 }
 
 // Prints feedback messages. This serves as a centralized method to provide additional
@@ -161,6 +164,10 @@ void report_feedback_message(uint8_t message_code)
       printPgmString(PSTR("Restoring spindle")); break;
     case MESSAGE_SLEEP_MODE:
       printPgmString(PSTR("Sleeping")); break;
+    #ifdef ENABLE_POSITION_RESTORE
+      case MESSAGE_POSITION_RESTORED:
+        printPgmString(PSTR("Pos restored")); break;
+    #endif
   }
   report_util_feedback_line_feed();
 }
@@ -218,6 +225,7 @@ void report_grbl_settings() {
         case 1: report_util_float_setting(val+idx,settings.max_rate[idx],N_DECIMAL_SETTINGVALUE); break;
         case 2: report_util_float_setting(val+idx,settings.acceleration[idx]/(60*60),N_DECIMAL_SETTINGVALUE); break;
         case 3: report_util_float_setting(val+idx,-settings.max_travel[idx],N_DECIMAL_SETTINGVALUE); break;
+        case 4: report_util_float_setting(val+idx,settings.backlash[idx],N_DECIMAL_SETTINGVALUE); break;
       }
     }
     val += AXIS_SETTINGS_INCREMENT;
@@ -241,6 +249,98 @@ void report_probe_parameters()
 }
 
 
+#ifdef ENABLE_STEPPER_ISR_PROFILER
+  // Prints the stepper ISR profile as [ISR:min,avg,max:ticks:skipped,late] in microseconds, followed
+  // by the histogram tick counts per 4us bin as [ISRH:n0,n1,...]. Times read zero until a tick is profiled.
+  void report_stepper_isr_profile()
+  {
+    st_isr_profile_t profile;
+    st_get_isr_profile(&profile);
+    printPgmString(PSTR("[ISR:"));
+    if (profile.ticks) {
+      printFloat((float)profile.min_cycles/TICKS_PER_MICROSECOND,1);
+      serial_write(',');
+      printFloat((float)profile.sum_cycles/(profile.ticks*TICKS_PER_MICROSECOND),1);
+      serial_write(',');
+      printFloat((float)profile.max_cycles/TICKS_PER_MICROSECOND,1);
+    } else {
+      printPgmString(PSTR("0,0,0"));
+    }
+    serial_write(':');
+    print_uint32_base10(profile.ticks);
+    serial_write(':');
+    print_uint32_base10(profile.skipped);
+    serial_write(',');
+    print_uint32_base10(profile.late);
+    report_util_feedback_line_feed();
+    printPgmString(PSTR("[ISRH:"));
+    uint8_t idx;
+    for (idx=0; idx<ISR_PROFILE_BINS; idx++) {
+      if (idx) { serial_write(','); }
+      print_uint32_base10(profile.histogram[idx]);
+    }
+    report_util_feedback_line_feed();
+  }
+#endif
+
+
+#ifdef REPORT_FEED_HOLD_LATENCY
+  // Prints the time and straight-line travel since a feed hold request, as [HOLD:ms,distance].
+  void report_feed_hold_latency(uint32_t hold_ms, int32_t *start_position)
+  {
+    float start_mpos[N_AXIS], mpos[N_AXIS];
+    system_convert_array_steps_to_mpos(start_mpos,start_position);
+    system_convert_array_steps_to_mpos(mpos,sys_position);
+    float distance = 0.0;
+    uint8_t idx;
+    for (idx=0; idx<N_AXIS; idx++) {
+      float delta = mpos[idx]-start_mpos[idx];
+      distance += delta*delta;
+    }
+    printPgmString(PSTR("[HOLD:"));
+    print_uint32_base10(hold_ms);
+    serial_write(',');
+    printFloat_CoordValue(sqrt(distance));
+    report_util_feedback_line_feed();
+  }
+#endif
+
+
+#ifdef ENABLE_HEIGHT_MAP
+  // Prints the height map grid as [HMAP:nx,ny:origin x,y:spacing x,y] followed by one line of
+  // heights per grid row in Y, as [HMAP:row:z0,z1,...]. Only the header line, if no map is set.
+  void report_height_map()
+  {
+    uint8_t i, j;
+    printPgmString(PSTR("[HMAP:"));
+    print_uint8_base10(height_map.n[X_AXIS]);
+    serial_write(',');
+    print_uint8_base10(height_map.n[Y_AXIS]);
+    if (height_map.n[X_AXIS]) {
+      serial_write(':');
+      printFloat_CoordValue(height_map.origin[X_AXIS]);
+      serial_write(',');
+      printFloat_CoordValue(height_map.origin[Y_AXIS]);
+      serial_write(':');
+      printFloat_CoordValue(height_map.spacing[X_AXIS]);
+      serial_write(',');
+      printFloat_CoordValue(height_map.spacing[Y_AXIS]);
+    }
+    report_util_feedback_line_feed();
+    for (j=0; j<height_map.n[Y_AXIS]; j++) {
+      printPgmString(PSTR("[HMAP:"));
+      print_uint8_base10(j);
+      serial_write(':');
+      for (i=0; i<height_map.n[X_AXIS]; i++) {
+        if (i) { serial_write(','); }
+        printFloat_CoordValue(0.001*height_map.z[j*height_map.n[X_AXIS]+i]);
+      }
+      report_util_feedback_line_feed();
+    }
+  }
+#endif
+
+
 // Prints Grbl NGC parameters (coordinate offsets, probing)
 void report_ngc_parameters()
 {
@@ -433,14 +533,50 @@ void report_build_info(char *line)
   #ifndef HOMING_INIT_LOCK
     serial_write('L');
   #endif
+  #ifdef ENABLE_PROGRAM_MODE
+    serial_write('%');
+  #endif
+  #ifdef ENABLE_HEIGHT_MAP
+    serial_write('G');
+  #endif
+  #ifdef ENABLE_PROBE_LATCH
+    serial_write('B');
+  #endif
+  #ifdef ENABLE_POSITION_RESTORE
+    serial_write('K');
+  #endif
+  #ifdef ENABLE_CONTINUOUS_JOG
+    serial_write('J');
+  #endif
+  #ifdef ENABLE_BACKLASH_COMPENSATION
+    serial_write('Q');
+  #endif
+  #ifdef ENABLE_FAST_FEED_HOLD
+    serial_write('F');
+  #endif
+  #ifdef ENABLE_STEPPER_ISR_PROFILER
+    serial_write('U');
+  #endif
 
   // NOTE: Compiled values, like override increments/max/min values, may be added at some point later.
   serial_write(',');
   print_uint8_base10(BLOCK_BUFFER_SIZE-1);
   serial_write(',');
   print_uint8_base10(RX_BUFFER_SIZE);
-
   report_util_feedback_line_feed();
+
+  #ifdef REPORT_MEMORY_USAGE
+    // Buffer RAM in bytes: serial RX and TX, planner, step segments. Followed by the lowest stack headroom seen.
+    printPgmString(PSTR("[MEM:"));
+    print_uint32_base10(RX_BUFFER_SIZE+TX_BUFFER_SIZE+2);
+    serial_write(',');
+    print_uint32_base10(BLOCK_BUFFER_SIZE*sizeof(plan_block_t));
+    serial_write(',');
+    print_uint32_base10(st_get_buffer_ram_usage());
+    serial_write(',');
+    print_uint32_base10(system_get_stack_headroom());
+    report_util_feedback_line_feed();
+  #endif
 }
 
 
@@ -39,6 +39,8 @@
 #define STATUS_TRAVEL_EXCEEDED 15
 #define STATUS_INVALID_JOG_COMMAND 16
 #define STATUS_SETTING_DISABLED_LASER 17
+#define STATUS_BAUD_RATE_UNSUPPORTED 18
+#define STATUS_BAUD_RATE_NOT_CONFIRMED 19
 
 #define STATUS_GCODE_UNSUPPORTED_COMMAND 20
 #define STATUS_GCODE_MODAL_GROUP_VIOLATION 21
@@ -59,6 +61,7 @@
 #define STATUS_GCODE_UNUSED_WORDS 36
 #define STATUS_GCODE_G43_DYNAMIC_AXIS_ERROR 37
 #define STATUS_GCODE_MAX_VALUE_EXCEEDED 38
+#define STATUS_SETTING_BACKLASH_EXCEEDED 39
 
 // Define Grbl alarm codes. Valid values (1-255). 0 is reserved.
 #define ALARM_HARD_LIMIT_ERROR      EXEC_ALARM_HARD_LIMIT
@@ -83,6 +86,7 @@
 #define MESSAGE_RESTORE_DEFAULTS 9
 #define MESSAGE_SPINDLE_RESTORE 10
 #define MESSAGE_SLEEP_MODE 11
+#define MESSAGE_POSITION_RESTORED 12
 
 // Prints system status messages.
 void report_status_message(uint8_t status_code);
@@ -111,6 +115,21 @@ void report_realtime_status();
 // Prints recorded probe position
 void report_probe_parameters();
 
+#ifdef ENABLE_STEPPER_ISR_PROFILER
+  // Prints the stepper ISR execution time profile.
+  void report_stepper_isr_profile();
+#endif
+
+#ifdef REPORT_FEED_HOLD_LATENCY
+  // Prints the time and distance taken by a completed feed hold.
+  void report_feed_hold_latency(uint32_t hold_ms, int32_t *start_position);
+#endif
+
+#ifdef ENABLE_HEIGHT_MAP
+  // Prints the probed surface height map
+  void report_height_map();
+#endif
+
 // Prints Grbl NGC parameters (coordinate offsets, probe)
 void report_ngc_parameters();
 
@@ -24,7 +24,12 @@
 #define RX_RING_BUFFER (RX_BUFFER_SIZE+1)
 #define TX_RING_BUFFER (TX_BUFFER_SIZE+1)
 
-uint8_t serial_rx_buffer[RX_RING_BUFFER];
+#ifdef ENABLE_BUFFER_RAM_BUDGET
+  uint8_t *serial_rx_buffer; // Carved from free SRAM at power-up. See system_init_buffers().
+  uint8_t serial_rx_buffer_size;
+#else
+  uint8_t serial_rx_buffer[RX_RING_BUFFER];
+#endif
 uint8_t serial_rx_buffer_head = 0;
 volatile uint8_t serial_rx_buffer_tail = 0;
 
@@ -62,18 +67,111 @@ uint8_t serial_get_tx_buffer_count()
 }
 
 
-void serial_init()
+// Clock divider of a USART bit at a baud rate. The baud doubler is used for high baud rates, i.e. 115200.
+#define SERIAL_BAUD_DOUBLER_MIN 57600
+#define SERIAL_BAUD_DIVIDER(baud) ((baud) < SERIAL_BAUD_DOUBLER_MIN ? 16L : 8L)
+// UBRR0 register value, rounded to the nearest divisor.
+#define SERIAL_UBRR(baud) ((F_CPU + SERIAL_BAUD_DIVIDER(baud)*(baud)/2)/(SERIAL_BAUD_DIVIDER(baud)*(baud)) - 1)
+
+#if (SERIAL_UBRR(BAUD_RATE) < 0) || (SERIAL_UBRR(BAUD_RATE) > 4095)
+  #error "BAUD_RATE can't be generated at this F_CPU."
+#endif
+#if ((1000*(F_CPU/(SERIAL_BAUD_DIVIDER(BAUD_RATE)*(SERIAL_UBRR(BAUD_RATE)+1))))/BAUD_RATE > 1000+SERIAL_BAUD_MAX_ERROR) || \
+    ((1000*(F_CPU/(SERIAL_BAUD_DIVIDER(BAUD_RATE)*(SERIAL_UBRR(BAUD_RATE)+1))))/BAUD_RATE < 1000-SERIAL_BAUD_MAX_ERROR)
+  #warning "BAUD_RATE exceeds SERIAL_BAUD_MAX_ERROR at this F_CPU. Communication may be unreliable."
+#endif
+
+#ifdef ENABLE_BAUD_RATE_COMMAND
+  static uint32_t serial_baud_rate; // Active baud rate. Fallback for a failed baud rate change.
+#endif
+
+
+void serial_set_baud_rate(uint32_t baud)
 {
-  // Set baud rate
-  #if BAUD_RATE < 57600
-    uint16_t UBRR0_value = ((F_CPU / (8L * BAUD_RATE)) - 1)/2 ;
+  uint16_t UBRR0_value = SERIAL_UBRR(baud);
+  if (baud < SERIAL_BAUD_DOUBLER_MIN) {
     UCSR0A &= ~(1 << U2X0); // baud doubler off  - Only needed on Uno XXX
-  #else
-    uint16_t UBRR0_value = ((F_CPU / (4L * BAUD_RATE)) - 1)/2;
+  } else {
     UCSR0A |= (1 << U2X0);  // baud doubler on for high baud rates, i.e. 115200
-  #endif
+  }
   UBRR0H = UBRR0_value >> 8;
   UBRR0L = UBRR0_value;
+  #ifdef ENABLE_BAUD_RATE_COMMAND
+    serial_baud_rate = baud;
+  #endif
+}
+
+
+uint16_t serial_get_baud_error(uint32_t baud)
+{
+  if ((baud == 0) || (baud > F_CPU/8)) { return(0xffff); }
+  int32_t ubrr = SERIAL_UBRR(baud);
+  if ((ubrr < 0) || (ubrr > 4095)) { return(0xffff); }
+  uint32_t actual = F_CPU/(SERIAL_BAUD_DIVIDER(baud)*(ubrr+1));
+  uint32_t diff = (actual > baud) ? (actual-baud) : (baud-actual);
+  return((1000*diff+baud/2)/baud);
+}
+
+
+#ifdef ENABLE_BAUD_RATE_COMMAND
+  uint8_t serial_change_baud_rate(uint32_t baud)
+  {
+    if (serial_get_baud_error(baud) > SERIAL_BAUD_MAX_ERROR) { return(STATUS_BAUD_RATE_UNSUPPORTED); }
+    uint32_t old_baud = serial_baud_rate;
+
+    // Let pending output finish at the old rate. The last byte leaves the shift register after the
+    // buffer is empty, which takes at most a couple of milliseconds at the slowest supported rate.
+    while (serial_get_tx_buffer_count()) {
+      if (sys_rt_exec_state & EXEC_RESET) { return(STATUS_OK); }
+    }
+    delay_ms(2);
+
+    serial_set_baud_rate(baud);
+    serial_reset_read_buffer(); // Discard anything garbled during the switch.
+
+    // Wait for the sender to confirm the link with a '$B' line at the new rate. Anything else is
+    // ignored, since the sender may still be switching.
+    uint8_t match = 0;
+    uint16_t timeout = SERIAL_BAUD_CONFIRM_TIMEOUT;
+    while (timeout) {
+      if (sys_rt_exec_state & EXEC_RESET) { break; }
+      uint8_t data = serial_read();
+      if (data == SERIAL_NO_DATA) {
+        delay_ms(1);
+        timeout--;
+        continue;
+      }
+      if ((match == 0) && (data == '$')) { match = 1; }
+      else if ((match == 1) && (data == 'B')) { match = 2; }
+      else if ((match == 2) && ((data == '\n') || (data == '\r'))) {
+        // Drop the rest of a '\r\n' line end, which would otherwise be answered with an extra 'ok'.
+        // The sender waits for the 'ok' before sending more, so nothing else is discarded.
+        delay_ms(5);
+        serial_reset_read_buffer();
+        return(STATUS_OK);
+      }
+      else { match = 0; }
+    }
+
+    serial_set_baud_rate(old_baud);
+    serial_reset_read_buffer();
+    return(STATUS_BAUD_RATE_NOT_CONFIRMED);
+  }
+#endif
+
+
+#ifdef ENABLE_BUFFER_RAM_BUDGET
+  void serial_set_rx_buffer(uint8_t *buffer, uint8_t size)
+  {
+    serial_rx_buffer = buffer;
+    serial_rx_buffer_size = size;
+  }
+#endif
+
+
+void serial_init()
+{
+  serial_set_baud_rate(BAUD_RATE);
 
   // enable rx, tx, and interrupt on complete reception of a byte
   UCSR0B |= (1<<RXEN0 | 1<<TXEN0 | 1<<RXCIE0);
@@ -23,8 +23,17 @@
 #define serial_h
 
 
+#define RX_BUFFER_DEFAULT_SIZE 128
+#ifdef ENABLE_BUFFER_RAM_BUDGET
+  #ifdef RX_BUFFER_SIZE
+    #error "RX_BUFFER_SIZE can't be set with ENABLE_BUFFER_RAM_BUDGET. It is sized at power-up."
+  #endif
+  // RX buffer size set at power-up by serial_set_rx_buffer(). Limited to 8-bit indexing.
+  extern uint8_t serial_rx_buffer_size;
+  #define RX_BUFFER_SIZE serial_rx_buffer_size
+#endif
 #ifndef RX_BUFFER_SIZE
-  #define RX_BUFFER_SIZE 128
+  #define RX_BUFFER_SIZE RX_BUFFER_DEFAULT_SIZE
 #endif
 #ifndef TX_BUFFER_SIZE
   #ifdef USE_LINE_NUMBERS
@@ -36,9 +45,30 @@
 
 #define SERIAL_NO_DATA 0xff
 
+// Largest tolerated baud rate error in tenths of a percent. Both ends of the link share the budget
+// of about 5%, and USB-serial converters often have their own error.
+#define SERIAL_BAUD_MAX_ERROR 25
+
 
 void serial_init();
 
+#ifdef ENABLE_BUFFER_RAM_BUDGET
+  // Sets the RX ring buffer memory, size+1 bytes. Called once at power-up, before serial_init().
+  void serial_set_rx_buffer(uint8_t *buffer, uint8_t size);
+#endif
+
+// Sets the USART baud rate divisor for the given rate. Returns immediately, so any pending output
+// will be corrupted. Used by serial_init() and the baud rate command.
+void serial_set_baud_rate(uint32_t baud);
+
+// Returns the absolute baud rate error of the USART divisor for the given rate in tenths of a percent.
+uint16_t serial_get_baud_error(uint32_t baud);
+
+#ifdef ENABLE_BAUD_RATE_COMMAND
+  // Switches to a new baud rate and waits for the sender to confirm it. Falls back on failure.
+  uint8_t serial_change_baud_rate(uint32_t baud);
+#endif
+
 // Writes one byte to the TX serial buffer. Called by main program.
 void serial_write(uint8_t data);
 
@@ -23,6 +23,13 @@
 
 settings_t settings;
 
+#ifdef ENABLE_COORD_DATA_CACHE
+  // RAM copy of all coordinate data sets. Written back to EEPROM by settings_write_back_coord_data().
+  static float coord_cache[SETTING_INDEX_NCOORD+1][N_AXIS];
+  static uint8_t coord_cache_dirty;   // Sets awaiting write-back. One bit per set.
+  static uint8_t coord_cache_invalid; // Sets found corrupt at power up. Reported once as a read fail.
+#endif
+
 
 // Method to store startup lines into EEPROM
 void settings_store_startup_line(uint8_t n, char *line)
@@ -44,17 +51,70 @@ void settings_store_build_info(char *line)
 }
 
 
-// Method to store coord data parameters into EEPROM
-void settings_write_coord_data(uint8_t coord_select, float *coord_data)
+// Writes coord data parameters into EEPROM
+static void write_coord_data(uint8_t coord_select, float *coord_data)
 {
-  #ifdef FORCE_BUFFER_SYNC_DURING_EEPROM_WRITE
-    protocol_buffer_synchronize();
-  #endif
   uint32_t addr = coord_select*(sizeof(float)*N_AXIS+1) + EEPROM_ADDR_PARAMETERS;
   memcpy_to_eeprom_with_checksum(addr,(char*)coord_data, sizeof(float)*N_AXIS);
 }
 
 
+// Method to store coord data parameters. With the cache, the EEPROM write is deferred.
+void settings_write_coord_data(uint8_t coord_select, float *coord_data)
+{
+  #ifdef ENABLE_COORD_DATA_CACHE
+    memcpy(coord_cache[coord_select], coord_data, sizeof(float)*N_AXIS);
+    coord_cache_dirty |= bit(coord_select);
+  #else
+    #ifdef FORCE_BUFFER_SYNC_DURING_EEPROM_WRITE
+      protocol_buffer_synchronize();
+    #endif
+    write_coord_data(coord_select, coord_data);
+  #endif
+}
+
+
+#ifdef ENABLE_COORD_DATA_CACHE
+  // Writes a changed coordinate data set back to EEPROM. Called by the main loop, and writes at most
+  // one set per call, so the main loop is never held up for longer than one set. With the EEPROM write
+  // queue, a set is only written once it fits the queue entirely, so the write never waits. Without
+  // it, waits for the machine to be idle, since an EEPROM write then disables interrupts.
+  void settings_write_back_coord_data()
+  {
+    if (!coord_cache_dirty) { return; }
+    #ifdef ENABLE_EEPROM_WRITE_QUEUE
+      if (eeprom_get_queue_free() < sizeof(float)*N_AXIS+1) { return; } // Data and checksum.
+    #else
+      if ((sys.state != STATE_IDLE) && !(sys.state & (STATE_ALARM | STATE_CHECK_MODE))) { return; }
+      if (plan_get_current_block() != NULL) { return; } // Queued motion may start any time.
+    #endif
+    uint8_t idx;
+    for (idx=0; idx <= SETTING_INDEX_NCOORD; idx++) {
+      if (coord_cache_dirty & bit(idx)) {
+        bit_false(coord_cache_dirty, bit(idx));
+        write_coord_data(idx, coord_cache[idx]);
+        return;
+      }
+    }
+  }
+
+
+  // Loads all coordinate data sets from EEPROM into the cache. Corrupt sets are reset to zero.
+  static void load_coord_data()
+  {
+    uint8_t idx;
+    for (idx=0; idx <= SETTING_INDEX_NCOORD; idx++) {
+      uint32_t addr = idx*(sizeof(float)*N_AXIS+1) + EEPROM_ADDR_PARAMETERS;
+      if (!(memcpy_from_eeprom_with_checksum((char*)coord_cache[idx], addr, sizeof(float)*N_AXIS))) {
+        clear_vector_float(coord_cache[idx]);
+        write_coord_data(idx, coord_cache[idx]);
+        coord_cache_invalid |= bit(idx);
+      }
+    }
+  }
+#endif
+
+
 // Method to store Grbl global settings struct and version number into EEPROM
 // NOTE: This function can only be called in IDLE state.
 void write_global_settings()
@@ -106,7 +166,11 @@ void settings_restore(uint8_t restore_flag) {
     settings.max_travel[X_AXIS] = (-DEFAULT_X_MAX_TRAVEL);
     settings.max_travel[Y_AXIS] = (-DEFAULT_Y_MAX_TRAVEL);
     settings.max_travel[Z_AXIS] = (-DEFAULT_Z_MAX_TRAVEL);
+    settings.backlash[X_AXIS] = DEFAULT_X_BACKLASH;
+    settings.backlash[Y_AXIS] = DEFAULT_Y_BACKLASH;
+    settings.backlash[Z_AXIS] = DEFAULT_Z_BACKLASH;
 
+    system_update_travel_limits();
     write_global_settings();
   }
 
@@ -114,7 +178,12 @@ void settings_restore(uint8_t restore_flag) {
     uint8_t idx;
     float coord_data[N_AXIS];
     memset(&coord_data, 0, sizeof(coord_data));
-    for (idx=0; idx <= SETTING_INDEX_NCOORD; idx++) { settings_write_coord_data(idx, coord_data); }
+    for (idx=0; idx <= SETTING_INDEX_NCOORD; idx++) { write_coord_data(idx, coord_data); }
+    #ifdef ENABLE_COORD_DATA_CACHE
+      memset(coord_cache, 0, sizeof(coord_cache));
+      coord_cache_dirty = 0;
+      coord_cache_invalid = 0;
+    #endif
   }
 
   if (restore_flag & SETTINGS_RESTORE_STARTUP_LINES) {
@@ -165,14 +234,23 @@ uint8_t settings_read_build_info(char *line)
 // Read selected coordinate data from EEPROM. Updates pointed coord_data value.
 uint8_t settings_read_coord_data(uint8_t coord_select, float *coord_data)
 {
-  uint32_t addr = coord_select*(sizeof(float)*N_AXIS+1) + EEPROM_ADDR_PARAMETERS;
-  if (!(memcpy_from_eeprom_with_checksum((char*)coord_data, addr, sizeof(float)*N_AXIS))) {
-    // Reset with default zero vector
-    clear_vector_float(coord_data);
-    settings_write_coord_data(coord_select,coord_data);
-    return(false);
-  }
-  return(true);
+  #ifdef ENABLE_COORD_DATA_CACHE
+    memcpy(coord_data, coord_cache[coord_select], sizeof(float)*N_AXIS);
+    if (coord_cache_invalid & bit(coord_select)) {
+      bit_false(coord_cache_invalid, bit(coord_select));
+      return(false);
+    }
+    return(true);
+  #else
+    uint32_t addr = coord_select*(sizeof(float)*N_AXIS+1) + EEPROM_ADDR_PARAMETERS;
+    if (!(memcpy_from_eeprom_with_checksum((char*)coord_data, addr, sizeof(float)*N_AXIS))) {
+      // Reset with default zero vector
+      clear_vector_float(coord_data);
+      settings_write_coord_data(coord_select,coord_data);
+      return(false);
+    }
+    return(true);
+  #endif
 }
 
 
@@ -208,6 +286,9 @@ uint8_t settings_store_global_setting(uint8_t parameter, float value) {
             #ifdef MAX_STEP_RATE_HZ
               if (value*settings.max_rate[parameter] > (MAX_STEP_RATE_HZ*60.0)) { return(STATUS_MAX_STEP_RATE_EXCEEDED); }
             #endif
+            #ifdef ENABLE_BACKLASH_COMPENSATION
+              if (settings.backlash[parameter]*value > BACKLASH_STEPS_MAX) { return(STATUS_SETTING_BACKLASH_EXCEEDED); }
+            #endif
             settings.steps_per_mm[parameter] = value;
             break;
           case 1:
@@ -218,6 +299,13 @@ uint8_t settings_store_global_setting(uint8_t parameter, float value) {
             break;
           case 2: settings.acceleration[parameter] = value*60*60; break; // Convert to mm/min^2 for grbl internal use.
           case 3: settings.max_travel[parameter] = -value; break;  // Store as negative for grbl internal use.
+          case 4:
+            #ifdef ENABLE_BACKLASH_COMPENSATION
+              // The planner and stepper count backlash in 16-bit steps.
+              if (value*settings.steps_per_mm[parameter] > BACKLASH_STEPS_MAX) { return(STATUS_SETTING_BACKLASH_EXCEEDED); }
+            #endif
+            settings.backlash[parameter] = value;
+            break;
         }
         break; // Exit while-loop after setting has been configured and proceed to the EEPROM write call.
       } else {
@@ -301,6 +389,7 @@ uint8_t settings_store_global_setting(uint8_t parameter, float value) {
         return(STATUS_INVALID_STATEMENT);
     }
   }
+  system_update_travel_limits(); // Steps, travel or homing direction may have changed.
   write_global_settings();
   return(STATUS_OK);
 }
@@ -313,6 +402,10 @@ void settings_init() {
     settings_restore(SETTINGS_RESTORE_ALL); // Force restore all EEPROM data.
     report_grbl_settings();
   }
+  system_update_travel_limits();
+  #ifdef ENABLE_COORD_DATA_CACHE
+    load_coord_data();
+  #endif
 }
 
 
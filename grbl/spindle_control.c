@@ -121,6 +121,13 @@ void spindle_stop()
   void spindle_sync(uint8_t state, float rpm)
   {
     if (sys.state == STATE_CHECK_MODE) { return; }
+    #ifdef ENABLE_PROGRAM_MODE
+      // In program mode, skip the sync if the spindle is already running at the same speed step.
+      if (sys.program_mode && (state != SPINDLE_DISABLE) && bel_get_spindle_enable()) {
+        uint8_t pwm_value = spindle_compute_pwm_value(rpm);
+        if ((pwm_value != SPINDLE_PWM_OFF_VALUE) && (bel_get_spindle_speed() == (pwm_value-SPINDLE_PWM_MIN_VALUE))) { return; }
+      }
+    #endif
     protocol_buffer_synchronize(); // Empty planner buffer to ensure spindle is set when programmed.
     spindle_set_state(state,rpm);
   }
@@ -24,6 +24,12 @@
 
 // Some useful constants.
 #define DT_SEGMENT (1.0/(ACCELERATION_TICKS_PER_SECOND*60.0)) // min/segment
+#ifdef ADAPTIVE_SEGMENT_TIMING
+  #define DT_SEGMENT_RAMP (DT_SEGMENT/RAMP_SEGMENT_DIVISOR) // min/segment while changing speed
+  #define DT_SEGMENT_CRUISE (DT_SEGMENT*CRUISE_SEGMENT_MULTIPLIER) // min/segment at constant speed
+#endif
+#define DWELL_CYCLES_PER_TICK (F_CPU/1000) // Dwell segments tick once per millisecond.
+#define DWELL_TICKS_PER_SEGMENT (1000/ACCELERATION_TICKS_PER_SECOND) // ms/segment
 #define REQ_MM_INCREMENT_SCALAR 1.25
 #define RAMP_ACCEL 0
 #define RAMP_CRUISE 1
@@ -42,18 +48,11 @@
 // timer, and the CPU overhead. Level 0 (no AMASS, normal operation) frequency bin starts at the
 // Level 1 cutoff frequency and up to as fast as the CPU allows (over 30kHz in limited testing).
 // NOTE: AMASS cutoff frequency multiplied by ISR overdrive factor must not exceed maximum step frequency.
-// NOTE: Current settings are set to overdrive the ISR to no more than 16kHz, balancing CPU overhead
-// and timer accuracy.  Do not alter these settings unless you know what you are doing.
+// NOTE: The number of levels and the ISR over-drive budget are set by MAX_AMASS_LEVEL and
+// AMASS_ISR_FREQUENCY in config.h. Level n starts below AMASS_LEVEL1 << (n-1) cycles per step.
 #ifdef ADAPTIVE_MULTI_AXIS_STEP_SMOOTHING
-	#define MAX_AMASS_LEVEL 3
 	// AMASS_LEVEL0: Normal operation. No AMASS. No upper cutoff frequency. Starts at LEVEL1 cutoff frequency.
-	#define AMASS_LEVEL1 (F_CPU/8000) // Over-drives ISR (x2). Defined as F_CPU/(Cutoff frequency in Hz)
-	#define AMASS_LEVEL2 (F_CPU/4000) // Over-drives ISR (x4)
-	#define AMASS_LEVEL3 (F_CPU/2000) // Over-drives ISR (x8)
-
-  #if MAX_AMASS_LEVEL <= 0
-    error "AMASS must have 1 or more levels to operate correctly."
-  #endif
+	#define AMASS_LEVEL1 (F_CPU/(AMASS_ISR_FREQUENCY/2)) // Over-drives ISR (x2). Defined as F_CPU/(Cutoff frequency in Hz)
 #endif
 
 
@@ -70,6 +69,13 @@ typedef struct {
   #ifdef VARIABLE_SPINDLE
     uint8_t is_pwm_rate_adjusted; // Tracks motions that require constant laser power/rate
   #endif
+  #ifdef ENABLE_BACKLASH_COMPENSATION
+    uint16_t backlash_steps[N_AXIS]; // Remaining backlash steps. Counted down by the ISR, not reloaded.
+  #endif
+  #ifdef ENABLE_QUEUED_COOLANT
+    uint8_t is_coolant_update; // Flags a programmed coolant change applied as the block starts
+    uint8_t coolant_state;     // Programmed coolant state. Planner condition flags.
+  #endif
 } st_block_t;
 static st_block_t st_block_buffer[SEGMENT_BUFFER_SIZE-1];
 
@@ -89,6 +95,9 @@ typedef struct {
   #ifdef VARIABLE_SPINDLE
     uint8_t spindle_pwm;
   #endif
+  #ifdef ENABLE_FAST_FEED_HOLD
+    float exit_speed;        // Speed at the end of the segment. Restarts a truncated hold ramp. (mm/min)
+  #endif
 } segment_t;
 static segment_t segment_buffer[SEGMENT_BUFFER_SIZE];
 
@@ -129,6 +138,32 @@ static uint8_t dir_port_invert_mask;
 // Used to avoid ISR nesting of the "Stepper Driver Interrupt". Should never occur though.
 static volatile uint8_t busy;
 
+#ifdef ENABLE_STEPPER_ISR_PROFILER
+  static st_isr_profile_t isr_profile;
+
+  // Records the execution time of a completed step tick. Timer1 restarts counting at the compare
+  // match in CTC mode and runs at the CPU clock with AMASS, so TCNT1 holds the cycles since the tick
+  // started. A pending compare flag means the count already rolled over into the next tick.
+  static inline void st_profile_isr_exit()
+  {
+    uint16_t cycles = TCNT1;
+    if (TIFR1 & (1<<OCF1A)) {
+      if (isr_profile.late < 0xFFFF) { isr_profile.late++; }
+      return;
+    }
+    if (cycles < isr_profile.min_cycles) { isr_profile.min_cycles = cycles; }
+    if (cycles > isr_profile.max_cycles) { isr_profile.max_cycles = cycles; }
+    if (isr_profile.sum_cycles & 0x80000000) { // Halve both before the sum overflows.
+      isr_profile.sum_cycles >>= 1;
+      isr_profile.ticks >>= 1;
+    }
+    isr_profile.sum_cycles += cycles;
+    isr_profile.ticks++;
+    uint8_t bin = min(cycles >> ISR_PROFILE_BIN_SHIFT, ISR_PROFILE_BINS-1); // Shift, no 16-bit division.
+    if (isr_profile.histogram[bin] < 0xFFFF) { isr_profile.histogram[bin]++; }
+  }
+#endif
+
 // Pointers for the step segment being prepped from the planner buffer. Accessed only by the
 // main program. Pointers may be planning segments or planner blocks ahead of what being executed.
 static plan_block_t *pl_block;     // Pointer to the planner block being prepped
@@ -165,6 +200,10 @@ typedef struct {
     float inv_rate;    // Used by PWM laser mode to speed up segment calculations.
     uint8_t current_spindle_pwm; 
   #endif
+
+  #ifdef ENABLE_QUEUED_COOLANT
+    uint8_t coolant_state; // Programmed coolant state of the last prepped block.
+  #endif
 } st_prep_t;
 static st_prep_t prep;
 
@@ -212,6 +251,13 @@ static st_prep_t prep;
 // enabled. Startup init and limits call this function but shouldn't start the cycle.
 void st_wake_up()
 {
+  // Cancel a pending idle lock and restore the stepper timer clock. See st_go_idle().
+  TIMSK1 &= ~(1<<OCIE1B);
+  TCCR1B = (TCCR1B & ~((1<<CS12) | (1<<CS11))) | (1<<CS10);
+
+  #ifdef ENABLE_POSITION_RESTORE
+    system_invalidate_position(); // Moving. Position isn't restorable until the next controlled stop.
+  #endif
   // Enable stepper drivers.
   bel_set_steppers_enable(true);
   /*
@@ -220,6 +266,7 @@ void st_wake_up()
   */
   // Initialize stepper output bits to ensure first ISR call does not step.
   st.step_outbits = step_port_invert_mask;
+  bel_steppers_prepare(st.dir_outbits | st.step_outbits);
 
   // Initialize step pulse timing from settings. Here to ensure updating after re-writing.
   #ifdef STEP_PULSE_DELAY
@@ -246,14 +293,34 @@ void st_go_idle()
   busy = false;
 
   // Set stepper driver idle state, disabled or enabled, depending on settings and circumstances.
-  bool pin_state = false; // Keep enabled.
   if (((settings.stepper_idle_lock_time != 0xff) || sys_rt_exec_alarm || sys.state == STATE_SLEEP) && sys.state != STATE_HOMING) {
-    // Force stepper dwell to lock axes for a defined amount of time to ensure the axes come to a complete
-    // stop and not drift from residual inertial forces at the end of the last movement.
-    delay_ms(settings.stepper_idle_lock_time);
-    pin_state = true; // Override. Disable steppers.
+    // Keep the axes locked for a defined amount of time to ensure they come to a complete stop and
+    // not drift from residual inertial forces at the end of the last movement. Timer1, idle now,
+    // times the lock with its compare B interrupt, which then disables the steppers. This is
+    // called by the stepper ISR, so it must not wait here. New motion cancels it in st_wake_up().
+    if (settings.stepper_idle_lock_time) {
+      TCCR1B = (TCCR1B & ~((1<<CS12) | (1<<CS11) | (1<<CS10))) | ((1<<CS12) | (1<<CS10)); // 1/1024 prescaler
+      OCR1A = OCR1B = ((uint32_t)settings.stepper_idle_lock_time*(F_CPU/1024))/1000; // CTC top and match.
+      TCNT1 = 0;
+      TIFR1 = (1<<OCF1B); // Clear any stale match.
+      TIMSK1 |= (1<<OCIE1B);
+      bel_set_steppers_enable(true);
+    } else {
+      bel_set_steppers_enable(false);
+    }
+  } else {
+    TIMSK1 &= ~(1<<OCIE1B); // Keep enabled. Cancel a pending idle lock.
+    bel_set_steppers_enable(true);
   }
-  bel_set_steppers_enable(!pin_state);
+}
+
+
+// Stepper idle lock timeout. Disables the steppers, once the lock time set by st_go_idle() has elapsed.
+ISR(TIMER1_COMPB_vect)
+{
+  TIMSK1 &= ~(1<<OCIE1B); // One-shot.
+  TCCR1B = (TCCR1B & ~((1<<CS12) | (1<<CS11))) | (1<<CS10); // Reset clock to no prescaling.
+  bel_set_steppers_enable(false);
 }
 
 
@@ -300,6 +367,8 @@ void st_go_idle()
    NOTE: This interrupt must be as efficient as possible and complete before the next ISR tick,
    which for Grbl must be less than 33.3usec (@30kHz ISR rate). Oscilloscope measured time in
    ISR is 5usec typical and 25usec maximum, well below requirement.
+   NOTE: These figures are for stock Grbl. The Bungard bus writes add to every tick, so measure
+   this build with ENABLE_STEPPER_ISR_PROFILER.
    NOTE: This ISR expects at least one step to be executed per segment.
 */
 // TODO: Replace direct updating of the int32 position counters in the ISR somehow. Perhaps use smaller
@@ -307,7 +376,12 @@ void st_go_idle()
 // with probing and homing cycles that require true real-time positions.
 ISR(TIMER1_COMPA_vect)
 {
-  if (busy) { return; } // The busy-flag is used to avoid reentering this interrupt
+  if (busy) { // The busy-flag is used to avoid reentering this interrupt
+    #ifdef ENABLE_STEPPER_ISR_PROFILER
+      if (isr_profile.skipped < 0xFFFF) { isr_profile.skipped++; }
+    #endif
+    return;
+  }
 
   // Set the direction pins a couple of nanoseconds before we step the steppers
  /* DIRECTION_PORT = (DIRECTION_PORT & ~DIRECTION_MASK) | (st.dir_outbits & DIRECTION_MASK);
@@ -319,8 +393,8 @@ ISR(TIMER1_COMPA_vect)
     STEP_PORT = (STEP_PORT & ~STEP_MASK) | st.step_outbits;
   #endif */
   /* TODO: wrap this nicely when we are done with the homing algorithms */
-  if (st.step_outbits);
-    bel_steppers_step(st.dir_outbits | st.step_outbits); // Enable step pulse reset timer so that The Stepper Port Reset Interrupt can reset the signal after
+  bel_steppers_step_prepared(); // Port images prepared at the end of the previous tick.
+  // Enable step pulse reset timer so that The Stepper Port Reset Interrupt can reset the signal after
   // exactly settings.pulse_microseconds microseconds, independent of the main Timer1 prescaler.
  /* TCNT0 = st.step_pulse_time; // Reload Timer0 counter
   TCCR0B = (1<<CS01); // Begin Timer0. Full speed, 1/8 prescaler
@@ -352,6 +426,11 @@ ISR(TIMER1_COMPA_vect)
 
         // Initialize Bresenham line and distance counters
         st.counter_x = st.counter_y = st.counter_z = (st.exec_block->step_event_count >> 1);
+
+        #ifdef ENABLE_QUEUED_COOLANT
+          // Switch coolant programmed with this block, just prior to its first step.
+          if (st.exec_block->is_coolant_update) { coolant_set_state(st.exec_block->coolant_state); }
+        #endif
       }
       st.dir_outbits = st.exec_block->direction_bits ^ dir_port_invert_mask;
 
@@ -395,8 +474,14 @@ ISR(TIMER1_COMPA_vect)
   if (st.counter_x > st.exec_block->step_event_count) {
     st.step_outbits |= (1<<X_STEP_BIT);
     st.counter_x -= st.exec_block->step_event_count;
-    if (st.exec_block->direction_bits & (1<<X_DIRECTION_BIT)) { sys_position[X_AXIS]--; }
-    else { sys_position[X_AXIS]++; }
+    #ifdef ENABLE_BACKLASH_COMPENSATION
+      if (st.exec_block->backlash_steps[X_AXIS]) { st.exec_block->backlash_steps[X_AXIS]--; } // Slack only.
+      else if (st.exec_block->direction_bits & (1<<X_DIRECTION_BIT)) { sys_position[X_AXIS]--; }
+      else { sys_position[X_AXIS]++; }
+    #else
+      if (st.exec_block->direction_bits & (1<<X_DIRECTION_BIT)) { sys_position[X_AXIS]--; }
+      else { sys_position[X_AXIS]++; }
+    #endif
   }
   #ifdef ADAPTIVE_MULTI_AXIS_STEP_SMOOTHING
     st.counter_y += st.steps[Y_AXIS];
@@ -406,8 +491,14 @@ ISR(TIMER1_COMPA_vect)
   if (st.counter_y > st.exec_block->step_event_count) {
     st.step_outbits |= (1<<Y_STEP_BIT);
     st.counter_y -= st.exec_block->step_event_count;
-    if (st.exec_block->direction_bits & (1<<Y_DIRECTION_BIT)) { sys_position[Y_AXIS]--; }
-    else { sys_position[Y_AXIS]++; }
+    #ifdef ENABLE_BACKLASH_COMPENSATION
+      if (st.exec_block->backlash_steps[Y_AXIS]) { st.exec_block->backlash_steps[Y_AXIS]--; } // Slack only.
+      else if (st.exec_block->direction_bits & (1<<Y_DIRECTION_BIT)) { sys_position[Y_AXIS]--; }
+      else { sys_position[Y_AXIS]++; }
+    #else
+      if (st.exec_block->direction_bits & (1<<Y_DIRECTION_BIT)) { sys_position[Y_AXIS]--; }
+      else { sys_position[Y_AXIS]++; }
+    #endif
   }
   #ifdef ADAPTIVE_MULTI_AXIS_STEP_SMOOTHING
     st.counter_z += st.steps[Z_AXIS];
@@ -417,8 +508,14 @@ ISR(TIMER1_COMPA_vect)
   if (st.counter_z > st.exec_block->step_event_count) {
     st.step_outbits |= (1<<Z_STEP_BIT);
     st.counter_z -= st.exec_block->step_event_count;
-    if (st.exec_block->direction_bits & (1<<Z_DIRECTION_BIT)) { sys_position[Z_AXIS]--; }
-    else { sys_position[Z_AXIS]++; }
+    #ifdef ENABLE_BACKLASH_COMPENSATION
+      if (st.exec_block->backlash_steps[Z_AXIS]) { st.exec_block->backlash_steps[Z_AXIS]--; } // Slack only.
+      else if (st.exec_block->direction_bits & (1<<Z_DIRECTION_BIT)) { sys_position[Z_AXIS]--; }
+      else { sys_position[Z_AXIS]++; }
+    #else
+      if (st.exec_block->direction_bits & (1<<Z_DIRECTION_BIT)) { sys_position[Z_AXIS]--; }
+      else { sys_position[Z_AXIS]++; }
+    #endif
   }
 
   // During a homing cycle, lock out and prevent desired axes from moving.
@@ -432,7 +529,11 @@ ISR(TIMER1_COMPA_vect)
   }
 
   st.step_outbits ^= step_port_invert_mask;  // Apply step port invert mask
+  bel_steppers_prepare(st.dir_outbits | st.step_outbits); // Bus write for the next tick.
   busy = false;
+  #ifdef ENABLE_STEPPER_ISR_PROFILER
+    st_profile_isr_exit();
+  #endif
 }
 
 
@@ -521,6 +622,10 @@ void stepper_init()
   #ifdef STEP_PULSE_DELAY
     TIMSK0 |= (1<<OCIE0A); // Enable Timer0 Compare Match A interrupt
   #endif
+
+  #ifdef ENABLE_STEPPER_ISR_PROFILER
+    st_reset_isr_profile();
+  #endif
 }
 
 
@@ -535,6 +640,106 @@ void st_update_plan_block_parameters()
 }
 
 
+#ifdef ENABLE_FAST_FEED_HOLD
+  // Called upon a feed hold, before st_update_plan_block_parameters(). Drops the newest queued
+  // segments of the block being prepped, but always keeps the executing segment and the next one, so
+  // the ISR never runs dry while the deceleration is prepped. Their steps are returned to the planner
+  // block and the prep speed is rewound to the end of the last kept segment. With adaptive segment
+  // timing, a long cruise segment kept after the executing one is cut to 1/ACCELERATION_TICKS_PER_SECOND.
+  // NOTE: Segments of older blocks are kept, since those planner blocks are already discarded.
+  void st_truncate_segment_buffer()
+  {
+    if (pl_block == NULL) { return; } // Between blocks. Nothing to return the steps to.
+    if (pl_block->step_event_count == 0) { return; } // Dwells pause in the prep buffer instead.
+    if (sys.step_control & (STEP_CONTROL_EXECUTE_HOLD | STEP_CONTROL_EXECUTE_SYS_MOTION)) { return; }
+
+    uint16_t n_steps = 0;
+    #ifdef ADAPTIVE_SEGMENT_TIMING
+      // ISR ticks of one DT_SEGMENT at the rate of the segment following the executing one. Divided
+      // with interrupts enabled, and only used below if the ISR hasn't moved on to that segment.
+      uint8_t exec_index = segment_buffer_tail;
+      uint8_t next_index = exec_index+1;
+      if (next_index == SEGMENT_BUFFER_SIZE) { next_index = 0; }
+      segment_t *next_segment = &segment_buffer[next_index];
+      uint16_t n_keep = 0;
+      if (next_index != segment_buffer_head) {
+        uint32_t cycles = next_segment->cycles_per_tick;
+        #ifdef ADAPTIVE_MULTI_AXIS_STEP_SMOOTHING
+          n_keep = (F_CPU/ACCELERATION_TICKS_PER_SECOND)/cycles;
+          n_keep &= ~((1<<next_segment->amass_level)-1); // Whole steps only.
+          if (n_keep == 0) { n_keep = (1<<next_segment->amass_level); }
+        #else
+          if (next_segment->prescaler == 2) { cycles <<= 3; }
+          else if (next_segment->prescaler == 3) { cycles <<= 6; }
+          n_keep = (F_CPU/ACCELERATION_TICKS_PER_SECOND)/cycles;
+          if (n_keep == 0) { n_keep = 1; }
+        #endif
+      }
+    #endif
+    uint8_t sreg = SREG;
+    cli(); // Freeze the segment buffer tail. Only a few segments to scan.
+    for (;;) {
+      uint8_t n_queued = segment_buffer_head - segment_buffer_tail;
+      if (segment_buffer_head < segment_buffer_tail) { n_queued += SEGMENT_BUFFER_SIZE; }
+      if (n_queued <= 2) { break; }
+      uint8_t last_index = (segment_buffer_head == 0) ? (SEGMENT_BUFFER_SIZE-1) : (segment_buffer_head-1);
+      segment_t *last_segment = &segment_buffer[last_index];
+      if (last_segment->st_block_index != prep.st_block_index) { break; }
+      #ifdef ADAPTIVE_MULTI_AXIS_STEP_SMOOTHING
+        n_steps += (last_segment->n_step >> last_segment->amass_level);
+      #else
+        n_steps += last_segment->n_step;
+      #endif
+      segment_next_head = segment_buffer_head;
+      segment_buffer_head = last_index;
+    }
+    #ifdef ADAPTIVE_SEGMENT_TIMING
+      // Cut the segment following the executing one, if it is the last one queued of the block.
+      uint8_t after_index = next_index+1;
+      if (after_index == SEGMENT_BUFFER_SIZE) { after_index = 0; }
+      if ((segment_buffer_tail == exec_index) && (after_index == segment_buffer_head) &&
+          (next_segment->st_block_index == prep.st_block_index) && (n_keep < next_segment->n_step)) {
+        #ifdef ADAPTIVE_MULTI_AXIS_STEP_SMOOTHING
+          n_steps += (next_segment->n_step-n_keep) >> next_segment->amass_level;
+        #else
+          n_steps += next_segment->n_step-n_keep;
+        #endif
+        next_segment->n_step = n_keep;
+      }
+    #endif
+    SREG = sreg;
+    if (n_steps == 0) { return; }
+
+    uint8_t last_index = (segment_buffer_head == 0) ? (SEGMENT_BUFFER_SIZE-1) : (segment_buffer_head-1);
+    prep.current_speed = segment_buffer[last_index].exit_speed;
+    prep.steps_remaining += n_steps;
+    pl_block->millimeters = prep.steps_remaining/prep.step_per_mm; // Back on a whole step.
+    prep.dt_remainder = 0.0;
+  }
+#endif
+
+
+#ifdef ENABLE_STEPPER_ISR_PROFILER
+  void st_get_isr_profile(st_isr_profile_t *profile)
+  {
+    uint8_t sreg = SREG;
+    cli();
+    memcpy(profile,&isr_profile,sizeof(st_isr_profile_t));
+    SREG = sreg;
+  }
+
+
+  void st_reset_isr_profile()
+  {
+    uint8_t sreg = SREG;
+    cli();
+    memset(&isr_profile,0,sizeof(st_isr_profile_t));
+    isr_profile.min_cycles = 0xFFFF;
+    SREG = sreg;
+  }
+#endif
+
+
 // Increments the step segment buffer block data ring buffer.
 static uint8_t st_next_block_index(uint8_t block_index)
 {
@@ -641,6 +846,14 @@ void st_prep_buffer()
           for (idx=0; idx<N_AXIS; idx++) { st_prep_block->steps[idx] = pl_block->steps[idx] << MAX_AMASS_LEVEL; }
           st_prep_block->step_event_count = pl_block->step_event_count << MAX_AMASS_LEVEL;
         #endif
+        #ifdef ENABLE_BACKLASH_COMPENSATION
+          // Backlash steps included in the block are executed first on their axis. See plan_buffer_line().
+          for (idx=0; idx<N_AXIS; idx++) {
+            if (pl_block->backlash_axes & bit(idx)) { st_prep_block->backlash_steps[idx] = plan_get_backlash_steps(idx); }
+            else { st_prep_block->backlash_steps[idx] = 0; }
+          }
+          plan_set_backlash_dir_loaded(pl_block);
+        #endif
 
         // Initialize segment buffer data for generating the segments.
         prep.steps_remaining = (float)pl_block->step_event_count;
@@ -669,6 +882,20 @@ void st_prep_buffer()
             }
           }
         #endif
+
+        #ifdef ENABLE_QUEUED_COOLANT
+          // Flag a programmed coolant change for the ISR. System motions don't carry the coolant state.
+          // NOTE: Only changes are applied, so a coolant override lasts until the program changes it.
+          st_prep_block->is_coolant_update = false;
+          if (bit_isfalse(pl_block->condition,PL_COND_FLAG_SYSTEM_MOTION)) {
+            uint8_t coolant_state = pl_block->condition & PL_COND_COOLANT_MASK;
+            if (coolant_state != prep.coolant_state) {
+              prep.coolant_state = coolant_state;
+              st_prep_block->coolant_state = coolant_state;
+              st_prep_block->is_coolant_update = true;
+            }
+          }
+        #endif
       }
 
 			/* ---------------------------------------------------------------------------------
@@ -679,7 +906,12 @@ void st_prep_buffer()
 			*/
 			prep.mm_complete = 0.0; // Default velocity profile complete at 0.0mm from end of block.
 			float inv_2_accel = 0.5/pl_block->acceleration;
-			if (sys.step_control & STEP_CONTROL_EXECUTE_HOLD) { // [Forced Deceleration to Zero Velocity]
+			if (pl_block->step_event_count == 0) { // [Dwell]
+				// No motion and no velocity profile. Timed by step-less segments below.
+				prep.current_speed = 0.0;
+				prep.exit_speed = 0.0;
+				prep.recalculate_flag &= ~(PREP_FLAG_DECEL_OVERRIDE);
+			} else if (sys.step_control & STEP_CONTROL_EXECUTE_HOLD) { // [Forced Deceleration to Zero Velocity]
 				// Compute velocity profile parameters for a feed hold in-progress. This profile overrides
 				// the planner block profile, enforcing a deceleration to zero speed.
 				prep.ramp_type = RAMP_DECEL;
@@ -767,6 +999,43 @@ void st_prep_buffer()
       #endif
     }
     
+    // Dwell blocks are executed by step-less segments of up to DWELL_TICKS_PER_SEGMENT ticks of one
+    // millisecond each. Their millimeters value holds the remaining dwell time in milliseconds.
+    if (pl_block->step_event_count == 0) {
+      if (sys.step_control & STEP_CONTROL_EXECUTE_HOLD) {
+        // Pause the dwell. The remaining time is executed upon cycle resume.
+        bit_true(sys.step_control,STEP_CONTROL_END_MOTION);
+        return;
+      }
+      uint16_t dwell_ticks = lround(pl_block->millimeters);
+      if (dwell_ticks > DWELL_TICKS_PER_SEGMENT) { dwell_ticks = DWELL_TICKS_PER_SEGMENT; }
+      if (dwell_ticks) {
+        segment_t *dwell_segment = &segment_buffer[segment_buffer_head];
+        dwell_segment->st_block_index = prep.st_block_index;
+        dwell_segment->n_step = dwell_ticks;
+        dwell_segment->cycles_per_tick = DWELL_CYCLES_PER_TICK;
+        #ifdef ADAPTIVE_MULTI_AXIS_STEP_SMOOTHING
+          dwell_segment->amass_level = 0;
+        #else
+          dwell_segment->prescaler = 1; // prescaler: 0
+        #endif
+        #ifdef VARIABLE_SPINDLE
+          dwell_segment->spindle_pwm = prep.current_spindle_pwm; // Spindle keeps running during dwell.
+        #endif
+        #ifdef ENABLE_FAST_FEED_HOLD
+          dwell_segment->exit_speed = 0.0;
+        #endif
+        segment_buffer_head = segment_next_head;
+        if ( ++segment_next_head == SEGMENT_BUFFER_SIZE ) { segment_next_head = 0; }
+        pl_block->millimeters -= dwell_ticks;
+      }
+      if (pl_block->millimeters < 0.5) { // Dwell complete.
+        pl_block = NULL;
+        plan_discard_current_block();
+      }
+      continue;
+    }
+
     // Initialize new segment
     segment_t *prep_segment = &segment_buffer[segment_buffer_head];
 
@@ -787,7 +1056,12 @@ void st_prep_buffer()
       the end of planner block (typical) or mid-block at the end of a forced deceleration,
       such as from a feed hold.
     */
-    float dt_max = DT_SEGMENT; // Maximum segment time
+    #ifdef ADAPTIVE_SEGMENT_TIMING
+      float dt_segment = (prep.ramp_type == RAMP_CRUISE) ? DT_SEGMENT_CRUISE : DT_SEGMENT_RAMP;
+    #else
+      float dt_segment = DT_SEGMENT;
+    #endif
+    float dt_max = dt_segment; // Maximum segment time
     float dt = 0.0; // Initialize segment time
     float time_var = dt_max; // Time worker variable
     float mm_var; // mm-Distance worker variable
@@ -836,6 +1110,11 @@ void st_prep_buffer()
             time_var = (mm_remaining - prep.decelerate_after)/prep.maximum_speed;
             mm_remaining = prep.decelerate_after; // NOTE: 0.0 at EOB
             prep.ramp_type = RAMP_DECEL;
+            #ifdef ADAPTIVE_SEGMENT_TIMING
+              // End the segment at the deceleration junction. Only extended, if it has no step yet.
+              dt_segment = DT_SEGMENT_RAMP;
+              dt_max = dt + time_var;
+            #endif
           } else { // Cruising only.
             mm_remaining = mm_var;
           }
@@ -863,7 +1142,7 @@ void st_prep_buffer()
         if (mm_remaining > minimum_mm) { // Check for very slow segments with zero steps.
           // Increase segment time to ensure at least one step in segment. Override and loop
           // through distance calculations until minimum_mm or mm_complete.
-          dt_max += DT_SEGMENT;
+          dt_max += dt_segment;
           time_var = dt_max - dt;
         } else {
           break; // **Complete** Exit loop. Segment execution time maxed.
@@ -939,14 +1218,11 @@ void st_prep_buffer()
     #ifdef ADAPTIVE_MULTI_AXIS_STEP_SMOOTHING
       // Compute step timing and multi-axis smoothing level.
       // NOTE: AMASS overdrives the timer with each level, so only one prescalar is required.
-      if (cycles < AMASS_LEVEL1) { prep_segment->amass_level = 0; }
-      else {
-        if (cycles < AMASS_LEVEL2) { prep_segment->amass_level = 1; }
-        else if (cycles < AMASS_LEVEL3) { prep_segment->amass_level = 2; }
-        else { prep_segment->amass_level = 3; }
-        cycles >>= prep_segment->amass_level;
-        prep_segment->n_step <<= prep_segment->amass_level;
-      }
+      uint8_t amass_level = 0;
+      while ((amass_level < MAX_AMASS_LEVEL) && (cycles >= (AMASS_LEVEL1 << amass_level))) { amass_level++; }
+      prep_segment->amass_level = amass_level;
+      cycles >>= amass_level;
+      prep_segment->n_step <<= amass_level;
       if (cycles < (1UL << 16)) { prep_segment->cycles_per_tick = cycles; } // < 65536 (4.1ms @ 16MHz)
       else { prep_segment->cycles_per_tick = 0xffff; } // Just set the slowest speed possible.
     #else
@@ -967,6 +1243,10 @@ void st_prep_buffer()
       }
     #endif
 
+    #ifdef ENABLE_FAST_FEED_HOLD
+      prep_segment->exit_speed = prep.current_speed;
+    #endif
+
     // Segment complete! Increment segment buffer indices, so stepper ISR can immediately execute it.
     segment_buffer_head = segment_next_head;
     if ( ++segment_next_head == SEGMENT_BUFFER_SIZE ) { segment_next_head = 0; }
@@ -1014,3 +1294,11 @@ float st_get_realtime_rate()
   }
   return 0.0f;
 }
+
+
+#ifdef REPORT_MEMORY_USAGE
+  uint16_t st_get_buffer_ram_usage()
+  {
+    return(sizeof(segment_buffer)+sizeof(st_block_buffer));
+  }
+#endif
@@ -53,7 +53,39 @@ void st_prep_buffer();
 // Called by planner_recalculate() when the executing block is updated by the new plan.
 void st_update_plan_block_parameters();
 
+#ifdef ENABLE_STEPPER_ISR_PROFILER
+  #define ISR_PROFILE_BINS 8
+  #define ISR_PROFILE_BIN_SHIFT 6 // Histogram bin width of 64 cycles, 4us at 16MHz. Last bin is open-ended.
+
+  // Stepper ISR execution time statistics, in CPU cycles.
+  typedef struct {
+    uint32_t ticks;       // Step ticks profiled. Halved with the sum to keep the average.
+    uint32_t sum_cycles;
+    uint16_t min_cycles;
+    uint16_t max_cycles;
+    uint16_t skipped;     // Ticks dropped, since the previous tick was still busy.
+    uint16_t late;        // Ticks finishing after the next tick was already due.
+    uint16_t histogram[ISR_PROFILE_BINS];
+  } st_isr_profile_t;
+
+  // Copies the stepper ISR profile atomically.
+  void st_get_isr_profile(st_isr_profile_t *profile);
+
+  // Clears the stepper ISR profile.
+  void st_reset_isr_profile();
+#endif
+
+#ifdef ENABLE_FAST_FEED_HOLD
+  // Drops queued segments of the prepped block upon a feed hold, so deceleration starts sooner.
+  void st_truncate_segment_buffer();
+#endif
+
 // Called by realtime status reporting if realtime rate reporting is enabled in config.h.
 float st_get_realtime_rate();
 
+#ifdef REPORT_MEMORY_USAGE
+  // Returns the RAM used by the step segment and stepper block buffers in bytes.
+  uint16_t st_get_buffer_ram_usage();
+#endif
+
 #endif
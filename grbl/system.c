@@ -20,6 +20,9 @@
 
 #include "grbl.h"
 
+// Milliseconds since power-up, counted by the Timer2 compare interrupt. Read with system_get_tick().
+static volatile uint32_t sys_tick = 0;
+
 
 void system_init()
 {
@@ -31,6 +34,40 @@ void system_init()
   #endif
   CONTROL_PCMSK |= CONTROL_MASK;  // Enable specific pins of the Pin Change Interrupt
   PCICR |= (1 << CONTROL_INT);   // Enable Pin Change Interrupt
+
+  // Configure Timer2 as the 1kHz system tick. CTC mode with a 1/64 prescaler. Timer2 is otherwise
+  // unused, since the spindle is driven over the parallel bus and not by a PWM pin.
+  TCCR2A = (1<<WGM21);
+  TCCR2B = (1<<CS22);
+  OCR2A = (F_CPU/64/1000)-1;
+  TIMSK2 |= (1<<OCIE2A);
+}
+
+
+// System tick interrupt. Kept as short as possible, since it runs alongside the stepper ISR.
+ISR(TIMER2_COMPA_vect) { sys_tick++; }
+
+
+// Returns the milliseconds since power-up. The 32-bit counter is read atomically.
+uint32_t system_get_tick()
+{
+  uint8_t sreg = SREG;
+  cli();
+  uint32_t tick = sys_tick;
+  SREG = sreg;
+  return(tick);
+}
+
+
+// Returns a deadline the given number of milliseconds from now.
+uint32_t system_set_deadline(uint32_t ms) { return(system_get_tick()+ms); }
+
+
+// Returns true once the deadline has passed. Comparing the signed difference keeps this correct
+// across counter roll-over, for deadlines up to 24 days out.
+uint8_t system_deadline_passed(uint32_t deadline)
+{
+  return((int32_t)(system_get_tick()-deadline) >= 0);
 }
 
 
@@ -127,9 +164,19 @@ uint8_t system_execute_line(char *line)
     case 'J' : // Jogging
       // Execute only if in IDLE or JOG states.
       if (sys.state != STATE_IDLE && sys.state != STATE_JOG) { return(STATUS_IDLE_ERROR); }
+      #ifdef ENABLE_CONTINUOUS_JOG
+        if ((line[2] == 'C') && (line[3] == '=')) { return(jog_continuous_execute(line, 4)); }
+      #endif
       if(line[2] != '=') { return(STATUS_INVALID_STATEMENT); }
       return(gc_execute_line(line)); // NOTE: $J= is ignored inside g-code parser and used to detect jog motions.
       break;
+    #ifdef ENABLE_STEPPER_ISR_PROFILER
+      case 'T' : // Print or clear the stepper ISR profile. Any state, to profile running motions.
+        if ( line[2] == 0 ) { report_stepper_isr_profile(); }
+        else if ( (line[2] == '=') && (line[3] == '0') && (line[4] == 0) ) { st_reset_isr_profile(); }
+        else { return(STATUS_INVALID_STATEMENT); }
+        break;
+    #endif
     case '$': case 'G': case 'C': case 'X':
       if ( line[2] != 0 ) { return(STATUS_INVALID_STATEMENT); }
       switch( line[1] ) {
@@ -195,6 +242,58 @@ uint8_t system_execute_line(char *line)
             if (line[2] == 0) { system_execute_startup(line); }
           }
           break;
+        #ifdef ENABLE_BAUD_RATE_COMMAND
+          case 'B' : // Change baud rate [IDLE/ALARM]
+            if (line[2] != '=') { return(STATUS_INVALID_STATEMENT); }
+            char_counter = 3;
+            if (!read_float(line, &char_counter, &value)) { return(STATUS_BAD_NUMBER_FORMAT); }
+            if (line[char_counter] != 0) { return(STATUS_INVALID_STATEMENT); }
+            if (value < 0.0) { return(STATUS_NEGATIVE_VALUE); }
+            if (value > F_CPU) { return(STATUS_BAUD_RATE_UNSUPPORTED); }
+            protocol_buffer_synchronize(); // Serial reads block the main loop until confirmed.
+            return(serial_change_baud_rate(trunc(value)));
+        #endif
+        #ifdef ENABLE_HEIGHT_MAP
+          case 'P' : // Probe, print or clear the surface height map [IDLE/ALARM]
+            if (line[2] == 0) { report_height_map(); break; }
+            if (line[2] != '=') { return(STATUS_INVALID_STATEMENT); }
+            if ((line[3] == '0') && (line[4] == 0)) { probe_height_map_clear(); break; }
+            if (sys.state != STATE_IDLE) { return(STATUS_IDLE_ERROR); } // Probe only when idle.
+            {
+              float size[2] = {0.0, 0.0};
+              float feed_rate = 0.0, depth = 0.0, clearance = 0.0;
+              uint8_t n[2] = {0, 0};
+              char letter;
+              char_counter = 3;
+              while (line[char_counter] != 0) {
+                letter = line[char_counter++];
+                if (!read_float(line, &char_counter, &value)) { return(STATUS_BAD_NUMBER_FORMAT); }
+                if (value < 0.0) { return(STATUS_NEGATIVE_VALUE); }
+                switch (letter) {
+                  case 'X': size[X_AXIS] = value; break;
+                  case 'Y': size[Y_AXIS] = value; break;
+                  case 'I': n[X_AXIS] = min(value, 255); break;
+                  case 'J': n[Y_AXIS] = min(value, 255); break;
+                  case 'Z': depth = value; break;
+                  case 'F': feed_rate = value; break;
+                  case 'R': clearance = value; break;
+                  default: return(STATUS_INVALID_STATEMENT);
+                }
+              }
+              if ((n[X_AXIS] < 2) || (n[Y_AXIS] < 2) || (n[X_AXIS]*n[Y_AXIS] > HEIGHT_MAP_MAX_POINTS) ||
+                  (size[X_AXIS] == 0.0) || (size[Y_AXIS] == 0.0) || (depth == 0.0) || (feed_rate == 0.0)) {
+                return(STATUS_INVALID_STATEMENT);
+              }
+              if (gc_state.modal.units == UNITS_MODE_INCHES) {
+                size[X_AXIS] *= MM_PER_INCH;
+                size[Y_AXIS] *= MM_PER_INCH;
+                depth *= MM_PER_INCH;
+                clearance *= MM_PER_INCH;
+                feed_rate *= MM_PER_INCH;
+              }
+              return(mc_probe_height_map(size, n, feed_rate, depth, clearance));
+            }
+        #endif
         case 'S' : // Puts Grbl to sleep [IDLE/ALARM]
           if ((line[2] != 'L') || (line[3] != 'P') || (line[4] != 0)) { return(STATUS_INVALID_STATEMENT); }
           system_set_exec_state_flag(EXEC_SLEEP); // Set to execute sleep mode immediately
@@ -327,28 +426,84 @@ void system_convert_array_steps_to_mpos(float *position, int32_t *steps)
 #endif
 
 
-// Checks and reports if target array exceeds machine travel limits.
-uint8_t system_check_travel_limits(float *target)
+// Machine travel limits in steps. Precomputed from the settings, so the soft limit checks of all
+// planned lines are integer compares. See system_update_travel_limits().
+static int32_t system_travel_min[N_AXIS];
+static int32_t system_travel_max[N_AXIS];
+
+
+// Converts the travel settings to step-space limits. Called whenever settings are loaded or changed.
+void system_update_travel_limits()
 {
   uint8_t idx;
   for (idx=0; idx<N_AXIS; idx++) {
+    // NOTE: max_travel is stored as negative
+    int32_t travel_steps = lround(settings.max_travel[idx]*settings.steps_per_mm[idx]);
     #ifdef HOMING_FORCE_SET_ORIGIN
       // When homing forced set origin is enabled, soft limits checks need to account for directionality.
-      // NOTE: max_travel is stored as negative
       if (bit_istrue(settings.homing_dir_mask,bit(idx))) {
-        if (target[idx] < 0 || target[idx] > -settings.max_travel[idx]) { return(true); }
-      } else {
-        if (target[idx] > 0 || target[idx] < settings.max_travel[idx]) { return(true); }
+        system_travel_min[idx] = 0;
+        system_travel_max[idx] = -travel_steps;
+        continue;
       }
-    #else
-      // NOTE: max_travel is stored as negative
-      if (target[idx] > 0 || target[idx] < settings.max_travel[idx]) { return(true); }
     #endif
+    system_travel_min[idx] = travel_steps;
+    system_travel_max[idx] = 0;
+  }
+}
+
+
+// Checks and reports if target step array exceeds machine travel limits.
+uint8_t system_check_travel_steps(int32_t *target_steps)
+{
+  uint8_t idx;
+  for (idx=0; idx<N_AXIS; idx++) {
+    if (target_steps[idx] < system_travel_min[idx] || target_steps[idx] > system_travel_max[idx]) { return(true); }
   }
   return(false);
 }
 
 
+// Checks and reports if target array exceeds machine travel limits. Converts to steps like the
+// planner does, so a target is accepted or rejected the same way here as in plan_buffer_line().
+uint8_t system_check_travel_limits(float *target)
+{
+  int32_t target_steps[N_AXIS];
+  uint8_t idx;
+  for (idx=0; idx<N_AXIS; idx++) { target_steps[idx] = lround(target[idx]*settings.steps_per_mm[idx]); }
+  return(system_check_travel_steps(target_steps));
+}
+
+
+// Returns the distance from a position along a unit vector to the machine travel limits. Zero, if
+// the position is already outside of them.
+float system_get_travel_distance(float *position, float *unit_vec)
+{
+  float distance = SOME_LARGE_VALUE;
+  float limit;
+  uint8_t idx;
+  for (idx=0; idx<N_AXIS; idx++) {
+    if (unit_vec[idx] > 0.0) { limit = system_travel_max[idx]/settings.steps_per_mm[idx]; }
+    else if (unit_vec[idx] < 0.0) { limit = system_travel_min[idx]/settings.steps_per_mm[idx]; }
+    else { continue; }
+    distance = min(distance, (limit-position[idx])/unit_vec[idx]);
+  }
+  return(max(distance, 0.0));
+}
+
+
+// Clamps a target array to the machine travel limits. Keeps targets computed up to the travel
+// distance from failing the soft limit check on a rounding error.
+void system_clamp_travel_limits(float *target)
+{
+  uint8_t idx;
+  for (idx=0; idx<N_AXIS; idx++) {
+    target[idx] = max(target[idx], system_travel_min[idx]/settings.steps_per_mm[idx]);
+    target[idx] = min(target[idx], system_travel_max[idx]/settings.steps_per_mm[idx]);
+  }
+}
+
+
 // Special handlers for setting and clearing Grbl's real-time execution flags.
 void system_set_exec_state_flag(uint8_t mask) {
   uint8_t sreg = SREG;
@@ -405,3 +560,85 @@ void system_clear_exec_accessory_overrides() {
   sys_rt_exec_accessory_override = 0;
   SREG = sreg;
 }
+
+#if defined(REPORT_MEMORY_USAGE) || defined(ENABLE_BUFFER_RAM_BUDGET)
+  extern uint8_t __heap_start; // Linker symbol. First free SRAM byte after .data and .bss.
+  static uint8_t *system_free_start = &__heap_start; // Moved up by the buffers carved at power-up.
+#endif
+
+#ifdef ENABLE_BUFFER_RAM_BUDGET
+  #define BUFFER_BUDGET_MIN_BLOCKS 8
+  #define BUFFER_BUDGET_MIN_RX 64
+
+  // Carves the RX and planner buffers from the free SRAM between the static variables and the stack,
+  // less the stack reserve. The buffer chosen by the policy keeps its default size and the other gets
+  // the rest, within its 8-bit index limit. Grbl doesn't use malloc(), so nothing else claims this
+  // region. Called first at power-up, while the stack is shallow.
+  void system_init_buffers()
+  {
+    int16_t budget = (int16_t)((uint8_t *)SP - system_free_start) - BUFFER_STACK_RESERVE;
+    uint8_t n_rx;
+    uint8_t n_blocks;
+    #if (BUFFER_BUDGET_POLICY == BUFFER_BUDGET_RX)
+      n_blocks = BLOCK_BUFFER_DEFAULT_SIZE;
+      budget = (budget-(int16_t)(n_blocks*sizeof(plan_block_t))) - 1; // RX ring takes one extra byte.
+      n_rx = max(BUFFER_BUDGET_MIN_RX, min(254, budget));
+    #else
+      n_rx = RX_BUFFER_DEFAULT_SIZE;
+      budget = (budget-(n_rx+1))/(int16_t)sizeof(plan_block_t);
+      n_blocks = max(BUFFER_BUDGET_MIN_BLOCKS, min(255, budget));
+    #endif
+    plan_set_block_buffer((plan_block_t *)system_free_start, n_blocks);
+    system_free_start += n_blocks*sizeof(plan_block_t);
+    serial_set_rx_buffer(system_free_start, n_rx);
+    system_free_start += n_rx+1;
+  }
+#endif
+
+#ifdef REPORT_MEMORY_USAGE
+  #define STACK_CANARY 0xC5
+
+  // Paints from the end of static variables, or the buffers carved from the free SRAM, up to just
+  // below the current stack pointer. Grbl doesn't use malloc(), so this entire region belongs to
+  // the stack.
+  void system_paint_stack()
+  {
+    uint8_t *p = system_free_start;
+    uint8_t *sp = (uint8_t *)SP;
+    while (p < sp) { *p++ = STACK_CANARY; }
+  }
+
+
+  // Counts untouched canary bytes from the bottom of the free region. The deepest stack use since
+  // power-up overwrites the pattern, so the count is the minimum headroom reached so far.
+  uint16_t system_get_stack_headroom()
+  {
+    uint8_t *p = system_free_start;
+    uint16_t count = 0;
+    while ((*p == STACK_CANARY) && (p < (uint8_t *)SP)) { p++; count++; }
+    return(count);
+  }
+#endif
+
+
+#ifdef ENABLE_POSITION_RESTORE
+  #define POSITION_TOKEN_MAGIC 0x47524231 // Random RAM contents at power-up won't match.
+
+  static uint32_t sys_position_token __attribute__ ((section (".noinit")));
+
+  // Token is the magic number folded with the position, so a position altered after validation or
+  // only partially written is not restored.
+  static uint32_t system_position_token()
+  {
+    uint32_t token = POSITION_TOKEN_MAGIC;
+    uint8_t idx;
+    for (idx=0; idx<N_AXIS; idx++) { token = ((token << 5) | (token >> 27)) ^ sys_position[idx]; }
+    return(token);
+  }
+
+  void system_validate_position() { sys_position_token = system_position_token(); }
+
+  void system_invalidate_position() { sys_position_token = 0; }
+
+  uint8_t system_restore_position() { return(sys_position_token == system_position_token()); }
+#endif
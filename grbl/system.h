@@ -140,6 +140,12 @@ typedef struct {
   #ifdef ENABLE_PARKING_OVERRIDE_CONTROL
     uint8_t override_ctrl;     // Tracks override control states.
   #endif
+  #ifdef ENABLE_PROGRAM_MODE
+    uint8_t program_mode;      // Tracks if a '%' delimited program is being streamed. (boolean)
+  #endif
+  #ifdef ENABLE_CONTINUOUS_JOG
+    uint8_t jog_continuous;    // Tracks if continuous jog segments are being generated. (boolean)
+  #endif
   #ifdef VARIABLE_SPINDLE
     float spindle_speed;
   #endif
@@ -164,6 +170,15 @@ extern volatile uint8_t sys_rt_exec_accessory_override; // Global realtime execu
 // Initialize the serial protocol
 void system_init();
 
+// Returns the milliseconds since power-up, counted by the Timer2 system tick.
+uint32_t system_get_tick();
+
+// Returns a deadline the given number of milliseconds from now, for system_deadline_passed().
+uint32_t system_set_deadline(uint32_t ms);
+
+// Returns true once the system tick has reached the deadline. Safe across tick roll-over.
+uint8_t system_deadline_passed(uint32_t deadline);
+
 // Returns bitfield of control pin states, organized by CONTROL_PIN_INDEX. (1=triggered, 0=not triggered).
 uint8_t system_control_get_state();
 
@@ -191,9 +206,45 @@ void system_convert_array_steps_to_mpos(float *position, int32_t *steps);
   int32_t system_convert_corexy_to_y_axis_steps(int32_t *steps);
 #endif
 
+// Precomputes the step-space travel limits from the settings.
+void system_update_travel_limits();
+
+// Checks and reports if target step array exceeds machine travel limits.
+uint8_t system_check_travel_steps(int32_t *target_steps);
+
 // Checks and reports if target array exceeds machine travel limits.
 uint8_t system_check_travel_limits(float *target);
 
+// Returns the distance from a position along a unit vector to the machine travel limits.
+float system_get_travel_distance(float *position, float *unit_vec);
+
+// Clamps a target array to the machine travel limits.
+void system_clamp_travel_limits(float *target);
+
+#ifdef ENABLE_POSITION_RESTORE
+  // Marks sys_position as valid after a controlled stop, so it may be restored after a reset.
+  void system_validate_position();
+
+  // Marks sys_position as not restorable. Called when motion starts and on alarms.
+  void system_invalidate_position();
+
+  // Returns true, if sys_position still holds a valid position from before a reset.
+  uint8_t system_restore_position();
+#endif
+
+#ifdef ENABLE_BUFFER_RAM_BUDGET
+  // Sizes and places the RX and planner buffers in the free SRAM. Called first at power-up.
+  void system_init_buffers();
+#endif
+
+#ifdef REPORT_MEMORY_USAGE
+  // Fills unused SRAM between the heap and the stack with a canary pattern. Called at power-up.
+  void system_paint_stack();
+
+  // Returns the smallest number of free SRAM bytes left between the heap and the stack since power-up.
+  uint16_t system_get_stack_headroom();
+#endif
+
 // Special handlers for setting and clearing Grbl's real-time execution flags.
 void system_set_exec_state_flag(uint8_t mask);
 void system_clear_exec_state_flag(uint8_t mask);